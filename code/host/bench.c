@@ -0,0 +1,384 @@
+/**
+* @file
+* @brief Benchmark driver of the host build.
+*
+* Boots the firmware on the simulated hardware and, once it first goes to sleep,
+* replays canned HTTP requests through the W5100 model (accept, receive, INT1,
+* peer close), dispatching the events posted by the ISRs itself, and calls a few
+* module functions directly. For each case it
+* reports the host time spent servicing it (median and 99th percentile) along
+* with the simulated time and clock cycles the target spends on its buses and in
+* busy-wait delays (`bus-kcyc'), and the SPI traffic. The CPU work in between is
+* not modelled, so neither column is a measure of it; a change that only saves
+* instructions does not show. If the firmware has been built for profiling (see
+* sim_prof.c), @c -p also lists the (up to) @c count functions each case spends
+* most bus and delay cycles in, with their calls, those cycles and host time per
+* iteration.
+*
+* Usage: bench [-p count] [-n iterations] [-i flash-image]
+*/
+
+#include "sim.h"
+
+#include "defs.h"
+#include "event.h"
+#include "log.h"
+#include "json_parser.h"
+#include "param.h"
+#include "sbuffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+* @brief A canned request.
+*/
+typedef struct {
+    const char* name;
+    const char* request;
+
+    /** @brief Non-zero if the peer stops reading (see sim_net_stall()). */
+    uint8_t     stalled;
+} BenchCase;
+
+static const BenchCase cases[] = {
+    {"GET /index",
+     "GET /index HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: text/html\r\nAccept-Encoding: gzip, deflate\r\n"
+     "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n\r\n"},
+    /* The tag is that of index-min.html.gz, as listed by pack. */
+    {"GET /index (304)",
+     "GET /index HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: text/html\r\nAccept-Encoding: gzip, deflate\r\n"
+     "If-None-Match: \"af3b496e\"\r\n"
+     "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n\r\n"},
+    {"GET /style.css",
+     "GET /style.css HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: text/css,*/*;q=0.1\r\n\r\n"},
+    /* As a browser would send it; most of its headers are of no interest. */
+    {"GET /style.css (browser)",
+     "GET /style.css HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:38.0) Gecko/20100101 "
+     "Firefox/38.0\r\n"
+     "Accept: text/css,*/*;q=0.1\r\n"
+     "Accept-Language: en-US,en;q=0.8,el;q=0.6\r\n"
+     "Accept-Encoding: gzip, deflate\r\n"
+     "Referer: http://192.168.1.100/index\r\n"
+     "Cookie: session=5f2b1c9e0d4a7b3c8e6f1a2d9b0c7e4f; "
+     "theme=dark; lang=en; last-visit=2015-01-04T23:59:59Z\r\n"
+     "Connection: keep-alive\r\n"
+     "Cache-Control: max-age=0\r\n\r\n"},
+    {"GET /client.js",
+     "GET /client.js HTTP/1.1\r\nHost: 192.168.1.100\r\nAccept: */*\r\n\r\n"},
+    {"GET /client.js (206)",
+     "GET /client.js HTTP/1.1\r\nHost: 192.168.1.100\r\nAccept: */*\r\n"
+     "Range: bytes=4000-\r\n\r\n"},
+    {"GET /client.js (stalled)",
+     "GET /client.js HTTP/1.1\r\nHost: 192.168.1.100\r\nAccept: */*\r\n\r\n",
+     1},
+    {"GET /logo.png",
+     "GET /logo.png HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: image/png,image/*;q=0.8\r\n\r\n"},
+    {"GET /configuration",
+     "GET /configuration HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: application/json\r\n\r\n"},
+    {"GET /coordinates",
+     "GET /coordinates HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: application/json\r\n\r\n"},
+    {"GET /measurement",
+     "GET /measurement HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: application/json\r\n\r\n"},
+    {"GET /measurement?page",
+     "GET /measurement?page-size=10&page-index=2 HTTP/1.1\r\n"
+     "Host: 192.168.1.100\r\nAccept: application/json\r\n\r\n"},
+    {"GET /measurement (206)",
+     "GET /measurement HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: application/json\r\nRange: records=20-29\r\n\r\n"},
+    {"GET /measurement (binary)",
+     "GET /measurement HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: application/octet-stream\r\n\r\n"},
+    {"GET /measurement (CSV)",
+     "GET /measurement HTTP/1.1\r\nHost: 192.168.1.100\r\n"
+     "Accept: text/csv\r\n\r\n"},
+    {"GET /measurement?since",
+     "GET /measurement?date-since=2015-01-03T00:00:00 HTTP/1.1\r\n"
+     "Host: 192.168.1.100\r\nAccept: application/json\r\n\r\n"},
+    {"GET /missing",
+     "GET /missing HTTP/1.1\r\nHost: 192.168.1.100\r\n\r\n"},
+};
+
+#define CASES   (sizeof(cases)/sizeof(cases[0]))
+
+/**
+* @brief W5100 socket the requests arrive on; any of the HTTP sockets.
+*/
+#define BENCH_SOCKET    0
+
+/**
+* @brief Records the Log is filled with (see fill_log()).
+*/
+#define BENCH_RECORDS   90
+
+/**
+* @brief Iterations per case.
+*/
+static uint32_t iterations = 1000;
+
+/**
+* @brief Non-zero to report the functions of each case (up to this many).
+*/
+static uint16_t profile;
+
+/**
+* @brief Image of the Flash, with the UI assets (see pack.c).
+*/
+static const char* image = "../build/host/ui.img";
+
+/**
+* @brief Host time of each iteration of the current case.
+*/
+static uint64_t* samples;
+
+/**
+* @brief Response of the last iteration.
+*/
+static uint8_t  response[16384];
+static uint32_t response_len;
+
+static void sink(uint8_t s, const uint8_t* buf, uint16_t len) {
+    if(response_len + len > sizeof(response)) len = sizeof(response)
+                                                  - response_len;
+    memcpy(&response[response_len], buf, len);
+    response_len   +=  len;
+}
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static int cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+* @brief Prints a result line for the @p name case.
+*
+* @param[in] sim_ns Simulated time of all iterations.
+* @param[in] cycles Bus and delay cycles of all iterations (see
+*   sim_bus_cycles()).
+* @param[in] spi SPI bytes of all iterations.
+* @param[in] status HTTP status of the response, if any.
+*/
+static void report(const char* name, uint64_t sim_ns, uint64_t cycles,
+                   uint64_t spi, int status) {
+    qsort(samples, iterations, sizeof(uint64_t), cmp_u64);
+
+    printf("%-24s %9.2f %9.2f %10.3f %9.1f %8llu %7lu %4d\n", name,
+           samples[iterations / 2] / 1000.0,
+           samples[iterations * 99 / 100] / 1000.0,
+           sim_ns / (double)iterations / 1000000.0,
+           cycles / (double)iterations / 1000.0,
+           (unsigned long long)(spi / iterations),
+           (unsigned long)response_len, status);
+
+    if(profile) {
+        sim_prof_report(stdout, iterations, profile);
+        sim_prof_reset();
+    }
+}
+
+/**
+* @brief Services request @p c, @ref iterations times.
+*/
+static void run_case(const BenchCase* c) {
+    uint64_t sim_ns =  0;
+    uint64_t cycles =  0;
+    uint64_t spi    =  0;
+    uint32_t i;
+    int      status =  0;
+
+    for(i = 0 ; i < iterations ; ++i) {
+        uint64_t t0, s0, c0, b0;
+
+        response_len    =  0;
+        sim_net_accept(BENCH_SOCKET);
+        if(c->stalled) sim_net_stall(BENCH_SOCKET);
+        sim_net_receive(BENCH_SOCKET, (const uint8_t*)c->request,
+                        strlen(c->request));
+
+        s0  =  sim_clock_ns();
+        c0  =  sim_bus_cycles();
+        b0  =  sim_stats()->net_bytes + sim_stats()->fls_bytes;
+        t0  =  now_ns();
+
+        sim_service();
+        evt_dispatch();
+
+        samples[i]  =  now_ns() - t0;
+        sim_ns     +=  sim_clock_ns() - s0;
+        cycles     +=  sim_bus_cycles() - c0;
+        spi        +=  sim_stats()->net_bytes + sim_stats()->fls_bytes - b0;
+
+        /* The client closes the connection; the socket listens again. A
+        * stalled one has already been dropped. */
+        sim_net_close(BENCH_SOCKET);
+        sim_service();
+        evt_dispatch();
+    }
+
+    if(response_len > 12) status = atoi((const char*)&response[9]);
+    report(c->name, sim_ns, cycles, spi, status);
+}
+
+/**
+* @brief Fills the Log with #BENCH_RECORDS hourly records, starting 2015-01-01.
+*/
+static void fill_log() {
+    LogRecord rec;
+    uint16_t  i;
+
+    memset(&rec, 0, sizeof(rec));
+    for(i = 0 ; i < BENCH_RECORDS ; ++i) {
+        rec.date.year   =  0x15;
+        rec.date.mon    =  0x01;
+        rec.date.date   =  0x01 + (i / 24 / 10) * 16 + (i / 24) % 10;
+        rec.date.hour   =  ((i % 24) / 10) * 16 + (i % 24) % 10;
+        rec.x           =  i % 10;
+        rec.y           =  i / 10;
+        rec.t           =  200 + i % 50;
+        rec.rh          =  255;
+        rec.ph          =  255;
+        log_append(&rec);
+    }
+}
+
+/**
+* @brief Calls log_get_set() over a narrowing range of dates.
+*/
+static void run_log_get_set() {
+    BCDDate  since  = {.year = 0x15, .mon = 0x01, .date = 0x01};
+    BCDDate  until  = {.year = 0x15, .mon = 0x01, .date = 0x04, .hour = 0x12};
+    LogRecordSet set;
+    uint64_t s0     =  sim_clock_ns();
+    uint64_t c0     =  sim_bus_cycles();
+    uint32_t i;
+
+    response_len    =  0;
+    for(i = 0 ; i < iterations ; ++i) {
+        uint64_t t0 =  now_ns();
+
+        since.hour  =  i % 24 / 10 * 16 + i % 24 % 10;
+        log_get_set(&set, &since, &until);
+
+        samples[i]  =  now_ns() - t0;
+    }
+    report("log_get_set()", sim_clock_ns() - s0, sim_bus_cycles() - c0, 0, 0);
+}
+
+/**
+* @brief Serialises a Log-like record and flushes it, on an open connection.
+*/
+static void run_json_serialise() {
+    uint8_t  s_date[]  =  "2015-01-01T00:00:00.000Z";
+    uint8_t  s_temp[]  =  "20.0";
+    uint8_t  x = 1, y = 2, ph = 255, rh = 255;
+    uint8_t* tokens[]  =  {(uint8_t*)"date", (uint8_t*)"x", (uint8_t*)"y",
+                           (uint8_t*)"t", (uint8_t*)"ph", (uint8_t*)"rh"};
+    ParamValue params[] = {PARAM_STRING(s_date, sizeof(s_date)),
+                           PARAM_UINT8(x),
+                           PARAM_UINT8(y),
+                           PARAM_STRING(s_temp, sizeof(s_temp)),
+                           PARAM_UINT8(ph),
+                           PARAM_UINT8(rh)};
+    uint64_t s0, c0, b0;
+    uint32_t i;
+
+    sim_net_accept(BENCH_SOCKET);
+    set_socket_buf(BENCH_SOCKET);
+    s0  =  sim_clock_ns();
+    c0  =  sim_bus_cycles();
+    b0  =  sim_stats()->net_bytes;
+
+    for(i = 0 ; i < iterations ; ++i) {
+        uint64_t t0 =  now_ns();
+
+        response_len    =  0;
+        json_serialise(tokens, params, 6, SERIAL_ATOMIC_S
+                                        | SERIAL_ATOMIC_E
+                                        | SERIAL_FLUSH);
+        samples[i]  =  now_ns() - t0;
+    }
+    report("json_serialise()", sim_clock_ns() - s0, sim_bus_cycles() - c0,
+           sim_stats()->net_bytes - b0, 0);
+
+    sim_net_close(BENCH_SOCKET);
+    sim_service();
+    evt_dispatch();
+}
+
+/**
+* @brief Runs the benchmarks; called the first time the firmware sleeps.
+*/
+static void bench() {
+    uint32_t i;
+
+    /* Set the clock as a user would, once booted: 2015-01-05T00:00:00Z. */
+    sim_rtc_start(1420416000);
+    fill_log();
+
+    if(profile && !sim_prof_enabled()) {
+        fprintf(stderr, "bench: not built for profiling (see make profile)\n");
+        profile =  0;
+    }
+
+    printf("%-24s %9s %9s %10s %9s %8s %7s %4s\n", "case", "p50(us)",
+           "p99(us)", "bus(ms)", "bus-kcyc", "spi(B)", "resp(B)", "code");
+    if(profile) {
+        printf("  %-30s %9s %11s %9s\n", "function", "calls", "bus-cyc",
+               "host(us)");
+        sim_prof_reset();
+    }
+
+    for(i = 0 ; i < CASES ; ++i) run_case(&cases[i]);
+    run_log_get_set();
+    run_json_serialise();
+
+    exit(0);
+}
+
+int main(int argc, char** argv) {
+    int opt;
+
+    while((opt = getopt(argc, argv, "p:n:i:")) != -1) {
+        switch(opt) {
+            case 'p': profile    = strtoul(optarg, NULL, 10); break;
+            case 'n': iterations = strtoul(optarg, NULL, 10); break;
+            case 'i': image      = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-p count] [-n iterations] "
+                                "[-i image]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if(!iterations) iterations = 1;
+    samples =  malloc(iterations * sizeof(uint64_t));
+
+    sim_init();
+    if(sim_fls_load_file(0, image) < 0) {
+        fprintf(stderr, "%s: %s: cannot be read\n", argv[0], image);
+        return 1;
+    }
+
+    sim_net_set_sink(&sink);
+    sim_set_idle_hook(&bench);
+
+    return mcu_main();
+}
@@ -0,0 +1,33 @@
+/**
+* @file
+* @brief Host replacement of the avr-libc EEPROM API.
+*
+* @c EEMEM variables are collected in their own section; sim_eeprom.c maps
+* their addresses (as well as plain EEPROM offsets) onto the simulated 1KB
+* EEPROM.
+*/
+
+#ifndef SIM_AVR_EEPROM_H_INCL
+#define SIM_AVR_EEPROM_H_INCL
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#define EEMEM   __attribute__((section("sim_eeprom")))
+
+uint8_t  eeprom_read_byte(const uint8_t* addr);
+uint16_t eeprom_read_word(const uint16_t* addr);
+void     eeprom_read_block(void* dst, const void* src, size_t n);
+
+void     eeprom_write_byte(uint8_t* addr, uint8_t value);
+void     eeprom_write_word(uint16_t* addr, uint16_t value);
+void     eeprom_write_block(const void* src, void* dst, size_t n);
+
+void     eeprom_update_byte(uint8_t* addr, uint8_t value);
+void     eeprom_update_word(uint16_t* addr, uint16_t value);
+void     eeprom_update_block(const void* src, void* dst, size_t n);
+
+#define eeprom_is_ready()       1
+#define eeprom_busy_wait()      do {} while(0)
+
+#endif /* SIM_AVR_EEPROM_H_INCL */
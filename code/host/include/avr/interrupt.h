@@ -0,0 +1,23 @@
+/**
+* @file
+* @brief Host replacement of the avr-libc interrupt API.
+*
+* An ISR becomes an ordinary function named after its vector (see avr/io.h),
+* which the simulator calls whenever the corresponding peripheral requests it
+* and the global interrupt flag is set (see sim_service()).
+*/
+
+#ifndef SIM_AVR_INTERRUPT_H_INCL
+#define SIM_AVR_INTERRUPT_H_INCL
+
+#include <avr/io.h>
+
+#define ISR(vector, ...)    void vector(void); void vector(void)
+
+/* Interrupts pending when they get enabled are serviced right away. */
+void sim_sei();
+
+#define sei()               sim_sei()
+#define cli()               (SREG &= ~0x80)
+
+#endif /* SIM_AVR_INTERRUPT_H_INCL */
@@ -0,0 +1,253 @@
+/**
+* @file
+* @brief Host replacement of the ATmega328 I/O register definitions.
+*
+* Plain registers are simulated as byte (or word) variables owned by sim_io.c.
+* Those with side-effects on the bus (@c SPDR, @c SPSR, @c TWCR and @c PORTD,
+* which carries @c nCS of the W5100 and the Flash) expand to accessors that let
+* the simulated peripherals observe each access; so does @c PINC, which carries
+* the limit switches of the simulated motors. Bit numbers are those of the
+* *Atmel* datasheet so that the firmware may be built unmodified.
+*/
+
+#ifndef SIM_AVR_IO_H_INCL
+#define SIM_AVR_IO_H_INCL
+
+#include <inttypes.h>
+
+#ifndef _BV
+#define _BV(bit)                    (1 << (bit))
+#endif
+
+#define bit_is_set(sfr, bit)        ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit)      (!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit)     do {} while(bit_is_clear(sfr, bit))
+#define loop_until_bit_is_clear(sfr, bit)   do {} while(bit_is_set(sfr, bit))
+
+/* Registers with bus side-effects. */
+volatile uint8_t* sim_reg_SPDR();
+volatile uint8_t* sim_reg_SPSR();
+volatile uint8_t* sim_reg_TWCR();
+volatile uint8_t* sim_reg_PORTD();
+volatile uint8_t* sim_reg_PINC();
+
+#define SPDR        (*sim_reg_SPDR())
+#define SPSR        (*sim_reg_SPSR())
+#define TWCR        (*sim_reg_TWCR())
+#define PORTD       (*sim_reg_PORTD())
+#define PINC        (*sim_reg_PINC())
+
+/* Plain registers. */
+extern volatile uint8_t  sim_SPCR, sim_TWDR, sim_TWSR, sim_TWBR;
+extern volatile uint8_t  sim_PORTB, sim_PORTC, sim_DDRB, sim_DDRC, sim_DDRD;
+extern volatile uint8_t  sim_PINB, sim_PINC, sim_PIND;
+extern volatile uint8_t  sim_TCCR0A, sim_TCCR0B, sim_TCNT0, sim_OCR0A, sim_TIMSK0;
+extern volatile uint8_t  sim_TCCR1A, sim_TCCR1B, sim_TIMSK1;
+extern volatile uint16_t sim_TCNT1, sim_OCR1A, sim_OCR1B, sim_ICR1;
+extern volatile uint8_t  sim_PCICR, sim_PCMSK1, sim_EIMSK, sim_EICRA;
+extern volatile uint8_t  sim_MCUSR, sim_WDTCSR, sim_CLKPR, sim_SMCR, sim_SREG;
+extern volatile uint8_t  sim_UCSR0A, sim_UCSR0B, sim_UCSR0C, sim_UDR0;
+extern volatile uint8_t  sim_UBRR0H, sim_UBRR0L;
+
+#define SPCR        sim_SPCR
+#define TWDR        sim_TWDR
+#define TWSR        sim_TWSR
+#define TWBR        sim_TWBR
+#define PORTB       sim_PORTB
+#define PORTC       sim_PORTC
+#define DDRB        sim_DDRB
+#define DDRC        sim_DDRC
+#define DDRD        sim_DDRD
+#define PINB        sim_PINB
+#define PIND        sim_PIND
+#define TCCR0A      sim_TCCR0A
+#define TCCR0B      sim_TCCR0B
+#define TCNT0       sim_TCNT0
+#define OCR0A       sim_OCR0A
+#define TIMSK0      sim_TIMSK0
+#define TCCR1A      sim_TCCR1A
+#define TCCR1B      sim_TCCR1B
+#define TIMSK1      sim_TIMSK1
+#define TCNT1       sim_TCNT1
+#define OCR1A       sim_OCR1A
+#define OCR1B       sim_OCR1B
+#define ICR1        sim_ICR1
+#define PCICR       sim_PCICR
+#define PCMSK1      sim_PCMSK1
+#define EIMSK       sim_EIMSK
+#define EICRA       sim_EICRA
+#define MCUSR       sim_MCUSR
+#define WDTCSR      sim_WDTCSR
+#define CLKPR       sim_CLKPR
+#define SMCR        sim_SMCR
+#define SREG        sim_SREG
+#define UCSR0A      sim_UCSR0A
+#define UCSR0B      sim_UCSR0B
+#define UCSR0C      sim_UCSR0C
+#define UDR0        sim_UDR0
+#define UBRR0H      sim_UBRR0H
+#define UBRR0L      sim_UBRR0L
+
+/* Port bits. */
+#define PORTB0  0
+#define PORTB1  1
+#define PORTB2  2
+#define PORTB3  3
+#define PORTB4  4
+#define PORTB5  5
+#define PORTC0  0
+#define PORTC1  1
+#define PORTC2  2
+#define PORTC3  3
+#define PORTC4  4
+#define PORTC5  5
+#define PORTD0  0
+#define PORTD1  1
+#define PORTD2  2
+#define PORTD3  3
+#define PORTD4  4
+#define PORTD5  5
+#define PORTD6  6
+#define PORTD7  7
+#define DDB0    0
+#define DDB1    1
+#define DDB2    2
+#define DDB3    3
+#define DDB4    4
+#define DDB5    5
+#define DDC0    0
+#define DDC1    1
+#define DDC2    2
+#define DDC3    3
+#define DDD0    0
+#define DDD1    1
+#define DDD2    2
+#define DDD4    4
+#define DDD5    5
+#define DDD6    6
+#define DDD7    7
+
+/* SPI */
+#define SPIE    7
+#define SPE     6
+#define DORD    5
+#define MSTR    4
+#define CPOL    3
+#define CPHA    2
+#define SPR1    1
+#define SPR0    0
+#define SPIF    7
+#define WCOL    6
+#define SPI2X   0
+
+/* TWI */
+#define TWINT   7
+#define TWEA    6
+#define TWSTA   5
+#define TWSTO   4
+#define TWWC    3
+#define TWEN    2
+#define TWIE    0
+#define TWPS1   1
+#define TWPS0   0
+
+/* Timer/Counter 0 */
+#define COM0A1  7
+#define COM0A0  6
+#define COM0B1  5
+#define COM0B0  4
+#define WGM01   1
+#define WGM00   0
+#define FOC0A   7
+#define FOC0B   6
+#define WGM02   3
+#define CS02    2
+#define CS01    1
+#define CS00    0
+#define OCIE0B  2
+#define OCIE0A  1
+#define TOIE0   0
+
+/* Timer/Counter 1 */
+#define COM1A1  7
+#define COM1A0  6
+#define COM1B1  5
+#define COM1B0  4
+#define WGM11   1
+#define WGM10   0
+#define ICNC1   7
+#define ICES1   6
+#define WGM13   4
+#define WGM12   3
+#define CS12    2
+#define CS11    1
+#define CS10    0
+#define OCIE1B  2
+#define OCIE1A  1
+#define TOIE1   0
+
+/* External and pin change interrupts */
+#define INT1    1
+#define INT0    0
+#define ISC11   3
+#define ISC10   2
+#define ISC01   1
+#define ISC00   0
+#define PCIE2   2
+#define PCIE1   1
+#define PCIE0   0
+#define PCINT8  0
+#define PCINT9  1
+#define PCINT10 2
+#define PCINT11 3
+#define PCINT12 4
+#define PCINT13 5
+
+/* System control, Watchdog and clock */
+#define WDRF    3
+#define BORF    2
+#define EXTRF   1
+#define PORF    0
+#define WDIF    7
+#define WDIE    6
+#define WDP3    5
+#define WDCE    4
+#define WDE     3
+#define WDP2    2
+#define WDP1    1
+#define WDP0    0
+#define CLKPCE  7
+#define CLKPS3  3
+#define CLKPS2  2
+#define CLKPS1  1
+#define CLKPS0  0
+#define SM2     3
+#define SM1     2
+#define SM0     1
+#define SE      0
+
+/* USART0 */
+#define RXC0    7
+#define TXC0    6
+#define UDRE0   5
+#define U2X0    1
+#define RXCIE0  7
+#define TXCIE0  6
+#define UDRIE0  5
+#define RXEN0   4
+#define TXEN0   3
+#define UCSZ02  2
+#define UMSEL01 7
+#define UMSEL00 6
+#define UCSZ01  2
+#define UCSZ00  1
+#define UCPOL0  0
+
+/* Interrupt vectors; ISR() turns each into an ordinary function. */
+#define INT1_vect           sim_vect_INT1
+#define PCINT1_vect         sim_vect_PCINT1
+#define WDT_vect            sim_vect_WDT
+#define TIMER0_COMPA_vect   sim_vect_TIMER0_COMPA
+#define USART_RX_vect       sim_vect_USART_RX
+
+#endif /* SIM_AVR_IO_H_INCL */
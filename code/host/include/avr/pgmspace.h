@@ -0,0 +1,37 @@
+/**
+* @file
+* @brief Host replacement of the avr-libc program space API.
+*
+* The host has a single address space, so @c PROGMEM data are ordinary
+* (read-only) data and the @c _P variants map onto their standard counterparts.
+* pgm_read_word() reads the whole object @p addr points to; this keeps tables
+* of string addresses (16-bit on the AVR) working with host pointers.
+*/
+
+#ifndef SIM_AVR_PGMSPACE_H_INCL
+#define SIM_AVR_PGMSPACE_H_INCL
+
+#include <inttypes.h>
+#include <string.h>
+#include <strings.h>
+
+#define PROGMEM
+#define PGM_P                   const char*
+#define PSTR(s)                 (s)
+
+#define pgm_read_byte(addr)     (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)     (*(addr))
+#define pgm_read_ptr(addr)      (*(addr))
+
+#define strcpy_P(d, s)          strcpy((char*)(d), (const char*)(s))
+#define strncpy_P(d, s, n)      strncpy((char*)(d), (const char*)(s), n)
+#define strlen_P(s)             strlen((const char*)(s))
+#define strcmp_P(a, b)          strcmp((const char*)(a), (const char*)(b))
+#define strncmp_P(a, b, n)      strncmp((const char*)(a), (const char*)(b), n)
+#define strcasecmp_P(a, b)      strcasecmp((const char*)(a), (const char*)(b))
+#define strncasecmp_P(a, b, n)  strncasecmp((const char*)(a),               \
+                                            (const char*)(b), n)
+#define memcpy_P(d, s, n)       memcpy(d, s, n)
+#define memcmp_P(a, b, n)       memcmp(a, b, n)
+
+#endif /* SIM_AVR_PGMSPACE_H_INCL */
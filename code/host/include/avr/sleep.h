@@ -0,0 +1,22 @@
+/**
+* @file
+* @brief Host replacement of the avr-libc sleep API.
+*
+* Putting the CPU to sleep hands control to the host until the next simulated
+* event (see sim_sleep()).
+*/
+
+#ifndef SIM_AVR_SLEEP_H_INCL
+#define SIM_AVR_SLEEP_H_INCL
+
+#include <avr/io.h>
+
+void sim_sleep();
+
+#define set_sleep_mode(mode)    (SMCR = (SMCR & ~(_BV(SM2) | _BV(SM1)     \
+                                                | _BV(SM0))) | (mode))
+#define sleep_enable()          (SMCR |=  _BV(SE))
+#define sleep_disable()         (SMCR &= ~_BV(SE))
+#define sleep_cpu()             sim_sleep()
+
+#endif /* SIM_AVR_SLEEP_H_INCL */
@@ -0,0 +1,14 @@
+/**
+* @file
+* @brief The host C library string functions, plus those only avr-libc offers.
+*/
+
+#ifndef SIM_STRING_H_INCL
+#define SIM_STRING_H_INCL
+
+#include_next <string.h>
+
+char* strupr(char* s);
+char* strlwr(char* s);
+
+#endif /* SIM_STRING_H_INCL */
@@ -0,0 +1,20 @@
+/**
+* @file
+* @brief Host replacement of the avr-libc busy-wait delays.
+*
+* Delays advance the simulated clock instead of spinning. As on the target, the
+* requested duration is converted into cycles using the compile-time #F_CPU, so
+* a delay lasts longer (in simulated time) when the CPU actually runs slower.
+*/
+
+#ifndef SIM_UTIL_DELAY_H_INCL
+#define SIM_UTIL_DELAY_H_INCL
+
+#include <inttypes.h>
+
+void sim_delay_cycles(uint32_t cycles);
+
+#define _delay_us(us)   sim_delay_cycles((uint32_t)((us) * (F_CPU / 1e6)))
+#define _delay_ms(ms)   sim_delay_cycles((uint32_t)((ms) * (F_CPU / 1e3)))
+
+#endif /* SIM_UTIL_DELAY_H_INCL */
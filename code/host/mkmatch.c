@@ -0,0 +1,249 @@
+/**
+* @file
+* @brief Generates the tables the HTTP parser identifies tokens with.
+*
+* Reads the token groups of http_tokens.inc (compiled in) and writes, for each
+* group, the transition table of a case-insensitive automaton that recognises
+* its tokens one byte at a time (see match_token() in http_parser.c). A row is
+* a state in which more than one token remains possible: its first byte is the
+* index of the token that ends there, plus 1 (@c 0, if none), and the rest are
+* the next state for each character class. The next state is @c 0, if no token
+* continues with that class; the row, if more than one does; or the index of the
+* only token that does, ORed with @c 0x80, in which case the rest of the token is
+* compared as is. Every group shares the character classes.
+*
+* The output also checks that the "_MIN" and "_MAX" macros of each group (see
+* http_server.h) agree with the list.
+*
+* Usage: mkmatch > http_match.inc
+*/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+* @brief An entry of http_tokens.inc; either the start of a group or a token.
+*/
+typedef struct {
+    const char* group;
+    const char* token;
+} Spec;
+
+static const Spec spec[] = {
+    #define HTTP_GROUP(name)    {#name, NULL},
+    #define HTTP_TOKEN(token)   {NULL, token},
+    #include "http_tokens.inc"
+};
+
+#define SPECS   (sizeof(spec)/sizeof(spec[0]))
+
+/**
+* @brief Maximum tokens of a group; the index of one must fit in 7 bits.
+*/
+#define MATCH_TOKENS    127
+
+/**
+* @brief Maximum rows of a table.
+*/
+#define MATCH_ROWS      127
+
+/**
+* @brief The first and last characters with a class.
+*/
+#define MATCH_FIRST     ' '
+#define MATCH_LAST      '~'
+
+/**
+* @brief Character class of each character, as it is to be output.
+*/
+static unsigned char classes[256];
+
+/**
+* @brief Amount of character classes; the width of a row, less 1.
+*/
+static unsigned width;
+
+/**
+* @brief The character of each class (in lower-case).
+*/
+static int chars[256];
+
+/**
+* @brief A row: the prefix shared by the tokens still possible in its state.
+*/
+typedef struct {
+    const char* prefix;
+    unsigned    len;
+} Row;
+
+/**
+* @brief Writes the @p len characters of @p s within a comment, breaking up any
+* "/" and "*" pair (as in the media range of any type) with a backslash.
+*/
+static void put_comment(const char* s, unsigned len) {
+    unsigned i;
+
+    for(i = 0 ; i < len && s[i] ; ++i) {
+        putchar(s[i]);
+        if(i + 1 < len && s[i + 1] && (s[i] == '*' || s[i] == '/')
+           && s[i + 1] == (s[i] == '*' ? '/' : '*')) {
+            putchar('\\');
+        }
+    }
+}
+
+/**
+* @brief Returns the amount of @p count tokens that begin with the @p len
+* characters of @p prefix and continue with @p next ('\0' for any); @p last is
+* set to the index of the last of them.
+*/
+static unsigned count_tokens(const char** tokens, unsigned count,
+                             const char* prefix, unsigned len, int next,
+                             unsigned* last) {
+    unsigned n  =  0;
+    unsigned i;
+
+    for(i = 0 ; i < count ; ++i) {
+        if(strlen(tokens[i]) < len || strncmp(tokens[i], prefix, len)) continue;
+        if(next && tokens[i][len] != next) continue;
+        *last   =  i;
+        ++n;
+    }
+    return n;
+}
+
+/**
+* @brief Writes the table of the group @p name, the tokens of which are the
+* @p count of @p tokens.
+*
+* @returns @c 0 on success; @c -1, if the group does not fit in a table.
+*/
+static int put_group(const char* name, const char** tokens, unsigned count) {
+    Row      rows[MATCH_ROWS];
+    unsigned len    =  1;   /* Rows so far; the first is that of no input. */
+    unsigned r, k, i;
+    char     lower[64];
+
+    for(i = 0 ; name[i] && i < sizeof(lower) - 1 ; ++i) {
+        lower[i]    =  tolower((unsigned char)name[i]);
+    }
+    lower[i]        =  '\0';
+
+    rows[0].prefix  =  "";
+    rows[0].len     =  0;
+
+    printf("\n/* %s: ", name);
+    for(i = 0 ; i < count ; ++i) {
+        printf("%s", i ? " " : "");
+        put_comment(tokens[i], strlen(tokens[i]));
+    }
+    printf(" */\nstatic const uint8_t match_%s[] PROGMEM = {\n", lower);
+
+    for(r = 0 ; r < len ; ++r) {
+        const char* prefix  =  rows[r].prefix;
+        unsigned    plen    =  rows[r].len;
+        unsigned    end     =  0;
+
+        for(i = 0 ; i < count ; ++i) {
+            if(strlen(tokens[i]) == plen && !strncmp(tokens[i], prefix, plen)) {
+                end =  i + 1;
+            }
+        }
+        printf("    /* \"");
+        put_comment(prefix, plen);
+        printf("\" */ %u,", end);
+
+        for(k = 1 ; k <= width ; ++k) {
+            unsigned next   =  0;
+            unsigned last   =  0;
+            unsigned n;
+
+            n   =  count_tokens(tokens, count, prefix, plen, chars[k], &last);
+            if(n == 1) {
+                next    =  0x80 | last;
+            } else if(n > 1) {
+                if(len == MATCH_ROWS) return -1;
+                rows[len].prefix    =  tokens[last];
+                rows[len].len       =  plen + 1;
+                next                =  len++;
+            }
+            printf(" %u%s", next, k < width ? "," : "");
+        }
+        printf("%s\n", r + 1 < len ? "," : "");
+    }
+    printf("};\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* tokens[MATCH_TOKENS];
+    const char* group   =  NULL;
+    unsigned    count   =  0;
+    unsigned    total   =  0;   /* Tokens of the previous groups. */
+    unsigned    i;
+    int         c;
+
+    /* A class for each character in a token; a letter in either case. */
+    for(i = 0 ; i < SPECS ; ++i) {
+        const char* t;
+
+        for(t = spec[i].token ; t && *t ; ++t) {
+            c   =  (unsigned char)*t;
+            if(c < MATCH_FIRST || c > MATCH_LAST || isupper(c)) {
+                fprintf(stderr, "%s: %s: not lower-case, printable ASCII\n",
+                        argv[0], spec[i].token);
+                return 1;
+            }
+            if(!classes[c]) {
+                classes[c]      =  ++width;
+                chars[width]    =  c;
+            }
+            if(isalpha(c)) classes[toupper(c)] = classes[c];
+        }
+    }
+
+    printf("/*\n"
+           "* Generated by mkmatch (see code/host/mkmatch.c) from "
+           "http_tokens.inc; do not\n"
+           "* edit. Included by http_parser.c (see match_token()).\n"
+           "*/\n\n");
+
+    printf("/* Character class of each of ' ' up to '~'; 0, if it is in no "
+           "token. */\n"
+           "static const uint8_t match_class[] PROGMEM = {\n   ");
+    for(c = MATCH_FIRST ; c <= MATCH_LAST ; ++c) {
+        printf(" %u%s", classes[c], c < MATCH_LAST ? "," : "\n};\n");
+        if(c < MATCH_LAST && (c - MATCH_FIRST) % 16 == 15) printf("\n   ");
+    }
+
+    printf("\n/* Bytes per row of each table below. */\n"
+           "#define MATCH_WIDTH     %u\n", width + 1);
+
+    for(i = 0 ; i <= SPECS ; ++i) {
+        if(i < SPECS && spec[i].token) {
+            if(count == MATCH_TOKENS) {
+                fprintf(stderr, "%s: %s: too many tokens\n", argv[0], group);
+                return 1;
+            }
+            tokens[count++] =  spec[i].token;
+            continue;
+        }
+
+        if(group) {
+            printf("\n#if %s_MIN != %u || %s_MAX != %u\n"
+                   "#error \"%s_MIN or %s_MAX disagrees with "
+                   "http_tokens.inc\"\n"
+                   "#endif\n", group, total, group, count, group, group);
+
+            if(put_group(group, tokens, count)) {
+                fprintf(stderr, "%s: %s: too many rows\n", argv[0], group);
+                return 1;
+            }
+            total  +=  count;
+        }
+        if(i < SPECS) group = spec[i].group;
+        count   =  0;
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+/**
+* @file
+* @brief Packs the UI assets into an image of the Flash.
+*
+* Lays out each @c file given at the start of a page following the asset
+* directory and fills in the directory (see #FLS_TOC_PAGE), so that the
+* firmware may serve @c file at @c path without being rebuilt. The type of an
+* asset is that of its extension, ignoring a trailing @c .gz which, in turn,
+* marks it as compressed with gzip. Files listed more than once (such as the
+* index at both @c / and @c /index) are stored once.
+*
+* The image is meant to be stored at address @c 0 of the 25LC1024, one page at
+* a time over the USART (see USART_RX_vect), or loaded into the simulated one
+* (see sim_fls_load_file()).
+*
+* Usage: pack [-d directory] -o image path=file ...
+*/
+
+#include "flash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+* @brief Pages available to the image; the rest of the 25LC1024 holds the
+* measurement Log (see #FLS_LOG_PAGE).
+*/
+#define PACK_PAGES      FLS_LOG_PAGE
+
+/**
+* @brief Maximum size of an asset; that of FlsEntry#size.
+*/
+#define PACK_SIZE_MAX   0xFFFF
+
+/**
+* @brief Content type of each extension.
+*/
+static const char* types[][2] = {
+    {"html",    "text/html"},
+    {"css",     "text/css"},
+    {"js",      "text/javascript;charset=utf-8"},
+    {"png",     "image/png"},
+    {"json",    "application/json"},
+};
+
+#define TYPES   (sizeof(types)/sizeof(types[0]))
+
+/**
+* @brief Contents of each distinct file, as read.
+*/
+static uint8_t* contents[FLS_TOC_LEN];
+
+/**
+* @brief Image of the Flash being laid out.
+*/
+static uint8_t image[PACK_PAGES * 256];
+
+/**
+* @brief Returns the FNV-1a hash of @p len bytes of @p buf.
+*/
+static uint32_t fnv1a(const uint8_t* buf, uint32_t len) {
+    uint32_t h  =  2166136261u;
+
+    while(len--) {
+        h  ^=  *buf++;
+        h  *=  16777619u;
+    }
+    return h;
+}
+
+/**
+* @brief Sets the type and encoding of @p entry according to @p file.
+*/
+static void set_type(FlsEntry* entry, const char* file) {
+    char        ext[16] =  "";
+    const char* type    =  "application/octet-stream";
+    const char* dot;        /* Past the last dot of the base name. */
+    size_t      len     =  strlen(file);
+    uint8_t     i;
+
+    entry->encoding =  FLS_ENC_IDENTITY;
+    if(len > 3 && !strcmp(&file[len - 3], ".gz")) {
+        entry->encoding =  FLS_ENC_GZIP;
+        len            -=  3;
+    }
+
+    for(dot = &file[len] ; dot > file && dot[-1] != '.'
+                                      && dot[-1] != '/' ; --dot);
+    if(dot > file && dot[-1] == '.'
+       && (size_t)(&file[len] - dot) < sizeof(ext)) {
+        memcpy(ext, dot, &file[len] - dot);
+    }
+
+    for(i = 0 ; i < TYPES ; ++i) {
+        if(!strcmp(ext, types[i][0])) type = types[i][1];
+    }
+    strncpy((char*)entry->type, type, FLS_TYPE_LEN - 1);
+}
+
+/**
+* @brief Reads file @p path into @p buf (allocated).
+*
+* @returns The size of the file; @c -1, if it could not be read.
+*/
+static long read_file(const char* path, uint8_t** buf) {
+    FILE* f     =  fopen(path, "rb");
+    long  len;
+
+    if(!f) return -1;
+    fseek(f, 0, SEEK_END);
+    len     =  ftell(f);
+    rewind(f);
+
+    *buf    =  malloc(len ? len : 1);
+    if(fread(*buf, 1, len, f) != (size_t)len) len = -1;
+    fclose(f);
+    return len;
+}
+
+int main(int argc, char** argv) {
+    FlsEntry    toc[FLS_TOC_LEN + 1];
+    const char* dir     =  ".";
+    const char* out     =  NULL;
+    uint16_t    page    =  FLS_TOC_PAGE + FLS_TOC_PAGES;
+    uint8_t     count   =  0;
+    uint16_t    paths   =  0;   /* Bytes the firmware needs for the paths. */
+    FILE*       f;
+    int         opt;
+    int         i;
+
+    while((opt = getopt(argc, argv, "d:o:")) != -1) {
+        switch(opt) {
+            case 'd': dir  = optarg; break;
+            case 'o': out  = optarg; break;
+            default:  out  = NULL; optind = argc + 1; break;
+        }
+    }
+    if(!out || optind >= argc) {
+        fprintf(stderr, "Usage: %s [-d directory] -o image path=file ...\n",
+                argv[0]);
+        return 1;
+    }
+    /* The firmware serves no more than #RSRC_FILES_MAX assets (see
+    * rsrc_init()), fewer than the directory holds. */
+    if(argc - optind > (int)FLS_TOC_LEN || argc - optind > RSRC_FILES_MAX) {
+        fprintf(stderr, "%s: more than %u assets\n", argv[0],
+                (unsigned)(FLS_TOC_LEN < RSRC_FILES_MAX ? FLS_TOC_LEN
+                                                        : RSRC_FILES_MAX));
+        return 1;
+    }
+
+    memset(toc, 0, sizeof(toc));
+    memset(image, 0xFF, sizeof(image));
+
+    for(i = optind ; i < argc ; ++i) {
+        FlsEntry*   entry   =  &toc[count + 1];
+        char*       file    =  strchr(argv[i], '=');
+        char        path[512];
+        long        len;
+        uint8_t     j;
+
+        if(!file || argv[i][0] != '/' || file - argv[i] >= FLS_PATH_LEN) {
+            fprintf(stderr, "%s: %s: expected /path=file, with a path of up to "
+                            "%u characters\n", argv[0], argv[i],
+                    FLS_PATH_LEN - 1);
+            return 1;
+        }
+        memcpy(entry->path, argv[i], file - argv[i]);
+        ++file;
+
+        /* Nor does it serve those whose path (and null-byte) does not fit in
+        * #RSRC_PATHS_LEN along with the rest. */
+        paths  +=  file - argv[i];
+        if(paths > RSRC_PATHS_LEN) {
+            fprintf(stderr, "%s: %s: the paths exceed %u bytes\n", argv[0],
+                    argv[i], RSRC_PATHS_LEN);
+            return 1;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", dir, file);
+        len =  read_file(path, &contents[count]);
+        if(len < 0 || len > PACK_SIZE_MAX) {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], path,
+                    len < 0 ? "cannot be read" : "larger than 64KiB");
+            return 1;
+        }
+
+        set_type(entry, file);
+        entry->size =  len;
+        entry->etag =  fnv1a(contents[count], len);
+
+        /* Identical contents share their pages. */
+        for(j = 0 ; j < count ; ++j) {
+            if(toc[j + 1].size == entry->size
+               && !memcmp(contents[j], contents[count], len)) {
+                break;
+            }
+        }
+
+        if(j < count) {
+            entry->page =  toc[j + 1].page;
+        } else {
+            if(page + (len + 255) / 256 > PACK_PAGES) {
+                fprintf(stderr, "%s: %s: does not fit in the Flash\n", argv[0],
+                        path);
+                return 1;
+            }
+            entry->page =  page;
+            memcpy(&image[(uint32_t)page << 8], contents[count], len);
+            page       +=  (len + 255) / 256;
+        }
+        ++count;
+    }
+
+    /* The header occupies the first slot. */
+    memcpy(toc[0].path, FLS_TOC_MAGIC, sizeof(FLS_TOC_MAGIC) - 1);
+    toc[0].path[sizeof(FLS_TOC_MAGIC) - 1] =  count;
+    memcpy(&image[FLS_TOC_PAGE << 8], toc, sizeof(toc));
+
+    f   =  fopen(out, "wb");
+    if(!f || fwrite(image, 256, page, f) != page || fclose(f)) {
+        fprintf(stderr, "%s: %s: cannot be written\n", argv[0], out);
+        return 1;
+    }
+
+    for(i = 1 ; i <= count ; ++i) {
+        printf("%-20s %5u %6u %08x %s\n", (char*)toc[i].path, toc[i].page,
+               toc[i].size, toc[i].etag, (char*)toc[i].type);
+    }
+    return 0;
+}
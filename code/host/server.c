@@ -0,0 +1,362 @@
+/**
+* @file
+* @brief TCP bridge driver of the host build.
+*
+* Boots the firmware on the simulated hardware and connects the W5100 model to
+* real TCP connections, so that the HTTP server may be exercised with a browser,
+* @c curl or a load generator such as @c wrk.
+*
+* Each port a W5100 socket listens on (@c Sn_PORT) is served by a listening
+* socket of the host at that port plus an offset (port @c 80 on @c 8080, by
+* default). An incoming connection is accepted by a W5100 socket listening on
+* its port; while there is none, it waits in the backlog of the host, much like
+* a connection attempt to a busy unit. Then:
+*
+* - Data from the peer is delivered as the socket's Rx buffer has room for it,
+*   raising @c RECV.
+* - An orderly close by the peer (FIN) raises @c DISCON.
+* - A connection reset by the peer (or a failed write) raises @c TIMEOUT, as the
+*   W5100 does once its retransmissions are exhausted.
+* - Whatever the firmware sends is written to the connection, which is closed
+*   as soon as the W5100 socket leaves @c ESTABLISHED and @c CLOSE_WAIT.
+*
+* The simulated clock is advanced by the real time spent waiting for the peers,
+* so that the RTC, started at the time of the host, keeps that time and the
+* watchdog wakes the firmware up every 8s.
+*
+* Usage: server [-p port-offset] [-i flash-image]
+*/
+
+#include "sim.h"
+
+#include "w5100.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+* @brief Amount of W5100 sockets.
+*/
+#define SRV_SOCKETS         4
+
+/**
+* @brief A listening socket of the host and the W5100 port it serves.
+*/
+typedef struct {
+    uint16_t port;
+    int      fd;
+} Listener;
+
+/**
+* @brief Listening sockets; at most one per W5100 socket.
+*/
+static Listener listeners[SRV_SOCKETS];
+static uint8_t  listener_count;
+
+/**
+* @brief Connection of each W5100 socket or @c -1.
+*/
+static int conn[SRV_SOCKETS] = {-1, -1, -1, -1};
+
+/**
+* @brief Non-zero once the peer of a connection has closed its end.
+*/
+static uint8_t conn_eof[SRV_SOCKETS];
+
+/**
+* @brief Non-zero if a connection has been reset while the firmware wrote to
+* it.
+*/
+static uint8_t conn_reset[SRV_SOCKETS];
+
+/**
+* @brief Added to a W5100 port to get the port of the host serving it.
+*/
+static uint16_t port_offset = 8000;
+
+/**
+* @brief Image of the Flash, with the UI assets (see pack.c).
+*/
+static const char* image = "../build/host/ui.img";
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/**
+* @brief Non-zero if W5100 socket @p s is connected to a peer.
+*/
+static uint8_t is_connected(uint8_t s) {
+    uint8_t sr  =  sim_net_status(s);
+    return sr == NET_Sn_SR_ESTAB || sr == NET_Sn_SR_CLOSEWAIT;
+}
+
+/**
+* @brief Non-zero if W5100 socket @p s may accept a connection on @p port.
+*/
+static uint8_t is_listening(uint8_t s, uint16_t port) {
+    return conn[s] < 0
+        && sim_net_status(s) == NET_Sn_SR_LISTEN
+        && sim_net_port(s) == port;
+}
+
+/**
+* @brief Writes what the firmware sends on socket @p s to its connection.
+*/
+static void sink(uint8_t s, const uint8_t* buf, uint16_t len) {
+    ssize_t n;
+
+    if(conn[s] < 0 || conn_reset[s]) return;
+
+    while(len) {
+        n   =  send(conn[s], buf, len, MSG_NOSIGNAL);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            conn_reset[s]   =  1;
+            return;
+        }
+        buf    +=  n;
+        len    -=  n;
+    }
+}
+
+/**
+* @brief Opens a listening socket of the host for W5100 port @p port, unless
+* there is one already.
+*/
+static void listen_on(uint16_t port) {
+    struct sockaddr_in addr;
+    int     fd;
+    int     one =  1;
+    uint8_t i;
+
+    for(i = 0 ; i < listener_count ; ++i) {
+        if(listeners[i].port == port) return;
+    }
+    if(listener_count == SRV_SOCKETS) return;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family         =  AF_INET;
+    addr.sin_addr.s_addr    =  htonl(INADDR_LOOPBACK);
+    addr.sin_port           =  htons(port + port_offset);
+
+    fd  =  socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0
+    || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0
+    || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0
+    || listen(fd, 64) < 0
+    || fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+        fprintf(stderr, "server: port %u: %s\n", port + port_offset,
+                strerror(errno));
+        exit(1);
+    }
+
+    listeners[listener_count].port  =  port;
+    listeners[listener_count].fd    =  fd;
+    ++listener_count;
+
+    fprintf(stderr, "server: port %u on http://127.0.0.1:%u/\n", port,
+            port + port_offset);
+}
+
+/**
+* @brief Accepts pending connections of @p l on the W5100 sockets listening on
+* its port.
+*
+* The listening socket does not block, so that this returns as soon as the
+* backlog is empty, even if more W5100 sockets are listening.
+*/
+static void accept_on(Listener* l) {
+    int     fd;
+    int     one =  1;
+    uint8_t s;
+
+    for(s = 0 ; s < SRV_SOCKETS ; ++s) {
+        if(!is_listening(s, l->port)) continue;
+
+        fd  =  accept(l->fd, NULL, NULL);
+        if(fd < 0) return;
+
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        conn[s]         =  fd;
+        conn_eof[s]     =  0;
+        conn_reset[s]   =  0;
+        sim_net_accept(s);
+    }
+}
+
+/**
+* @brief Delivers data from the peer of W5100 socket @p s.
+*/
+static void receive_on(uint8_t s) {
+    uint8_t  buf[8192];
+    uint16_t len    =  sim_net_rx_free(s);
+    ssize_t  n;
+
+    if(len > sizeof(buf)) len = sizeof(buf);
+
+    n   =  recv(conn[s], buf, len, 0);
+    if(n > 0) {
+        sim_net_receive(s, buf, n);
+
+    } else if(n == 0) {
+        conn_eof[s]     =  1;
+        sim_net_close(s);
+
+    } else if(errno != EINTR && errno != EAGAIN) {
+        conn_eof[s]     =  1;
+        conn_reset[s]   =  1;
+    }
+}
+
+/**
+* @brief Closes the connections the firmware is done with and raises
+* @c TIMEOUT on those that have been reset.
+*
+* @returns Non-zero if @c TIMEOUT was raised on any socket.
+*/
+static uint8_t reap() {
+    uint8_t raised  =  0;
+    uint8_t s;
+
+    for(s = 0 ; s < SRV_SOCKETS ; ++s) {
+        if(conn[s] < 0) continue;
+
+        if(conn_reset[s] && is_connected(s)) {
+            sim_net_timeout(s);
+            raised  =  1;
+        }
+
+        if(!is_connected(s)) {
+            close(conn[s]);
+            conn[s]     =  -1;
+        }
+    }
+    return raised;
+}
+
+/**
+* @brief Has the firmware service the pending events, until it raises no more.
+*
+* @returns Non-zero if any ISR has been called; the events it posted are handled
+*   by the main loop of the firmware, once serve() returns.
+*/
+static uint8_t settle() {
+    uint8_t taken   =  0;
+
+    do {
+        taken  |=  sim_service();
+    } while(reap());
+    return taken;
+}
+
+/**
+* @brief Waits for the peers and services their events; called whenever the
+* firmware sleeps.
+*/
+static void serve() {
+    static uint8_t booted;
+    struct pollfd  fds[2 * SRV_SOCKETS];
+    uint8_t        sock[2 * SRV_SOCKETS];   /* W5100 socket of each of fds. */
+    uint8_t        n    =  0;
+    uint8_t        i, s;
+    uint64_t       t0;
+    uint64_t       wdt;
+
+    /* Set the clock as a user would, once booted. */
+    if(!booted) {
+        sim_rtc_start(time(NULL));
+        booted  =  1;
+    }
+
+    /* Let the firmware handle what has been raised so far, first. */
+    if(settle()) return;
+
+    for(s = 0 ; s < SRV_SOCKETS ; ++s) {
+        if(sim_net_status(s) == NET_Sn_SR_LISTEN) listen_on(sim_net_port(s));
+    }
+
+    for(i = 0 ; i < listener_count ; ++i) {
+        for(s = 0 ; s < SRV_SOCKETS ; ++s) {
+            if(is_listening(s, listeners[i].port)) break;
+        }
+        if(s == SRV_SOCKETS) continue;
+
+        fds[n].fd       =  listeners[i].fd;
+        fds[n].events   =  POLLIN;
+        sock[n]         =  i;
+        ++n;
+    }
+    for(s = 0 ; s < SRV_SOCKETS ; ++s) {
+        if(conn[s] < 0 || conn_eof[s] || !sim_net_rx_free(s)) continue;
+
+        fds[n].fd       =  conn[s];
+        fds[n].events   =  POLLIN;
+        sock[n]         =  s + SRV_SOCKETS;
+        ++n;
+    }
+
+    if(!n) {
+        fprintf(stderr, "server: no socket is listening or connected\n");
+        exit(1);
+    }
+
+    /* Wake up for the watchdog, as the target would. */
+    wdt =  sim_wdt_ns();
+    t0  =  now_ns();
+    if(poll(fds, n, wdt == UINT64_MAX ? -1 : (int)((wdt + 999999) / 1000000)) < 0
+    && errno != EINTR) {
+        perror("server: poll");
+        exit(1);
+    }
+    sim_sleep_ns(now_ns() - t0);
+
+    for(i = 0 ; i < n ; ++i) {
+        if(!fds[i].revents) continue;
+
+        if(sock[i] < SRV_SOCKETS) {
+            accept_on(&listeners[sock[i]]);
+        } else {
+            receive_on(sock[i] - SRV_SOCKETS);
+        }
+    }
+
+    settle();
+}
+
+int main(int argc, char** argv) {
+    int opt;
+
+    while((opt = getopt(argc, argv, "p:i:")) != -1) {
+        switch(opt) {
+            case 'p': port_offset = strtoul(optarg, NULL, 10); break;
+            case 'i': image       = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-p port-offset] [-i image]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    sim_init();
+    if(sim_fls_load_file(0, image) < 0) {
+        fprintf(stderr, "%s: %s: cannot be read\n", argv[0], image);
+        return 1;
+    }
+
+    sim_net_set_sink(&sink);
+    sim_set_idle_hook(&serve);
+
+    return mcu_main();
+}
@@ -0,0 +1,376 @@
+/**
+* @file
+* @brief Simulated hardware for building and running the firmware on a host.
+* @addtogroup sim Host simulator
+* @{
+*
+* The firmware is compiled unmodified against the headers in @c include/, which
+* turn register accesses into calls to this module. It provides models of the
+* peripherals the firmware talks to:
+*
+* - W5100 (SPI; @c nCS on @c PORTD7): common and socket registers and the Tx/Rx
+*   buffer memory. The host plays the remote peer through sim_net_accept(),
+*   sim_net_receive() and sim_net_close() and collects whatever the firmware
+*   sends through a sink (sim_net_set_sink()).
+* - 25LC1024 (SPI; @c nCS on @c PORTD1): 128KB with the read, write, erase and
+*   status commands of the datasheet, including write-in-progress timing.
+* - DS1307 (TWI): clock and battery-backed RAM, ticking with the simulated
+*   clock once started (sim_rtc_start()).
+* - EEPROM: 1KB, holding the @c EEMEM variables as well as data addressed
+*   by plain offsets (for instance, the Log records).
+* - Clock: a simulated time-base advanced by busy-wait delays and by bus
+*   traffic at the rates the firmware configures (CPU prescaler, SPI and TWI
+*   dividers). It estimates the time the target spends on the buses; it does not
+*   account for instructions.
+*/
+
+#ifndef SIM_H_INCL
+#define SIM_H_INCL
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+* @brief Frequency of the crystal oscillator (Arduino Uno).
+*
+* The CPU clock is this value divided by the @c CLKPR prescaler.
+*/
+#define SIM_F_OSC           16000000UL
+
+/**
+* @brief Size of the simulated EEPROM (ATmega328).
+*/
+#define SIM_EE_SIZE         1024
+
+/**
+* @brief Size of the simulated external Flash (25LC1024).
+*/
+#define SIM_FLS_SIZE        0x20000UL
+
+/**
+* @brief Size of the W5100 address space (registers and buffer memory).
+*/
+#define SIM_NET_MEM_SIZE    0x8000
+
+/**
+* @brief Receives data sent by the firmware on socket @p s.
+*/
+typedef void (*SimNetSink)(uint8_t s, const uint8_t* buf, uint16_t len);
+
+/**
+* @brief Bus traffic counters, accumulated since sim_init().
+*/
+typedef struct {
+    /** @brief Bytes exchanged with the W5100 over SPI. */
+    uint32_t net_bytes;
+
+    /** @brief Bytes exchanged with the Flash over SPI. */
+    uint32_t fls_bytes;
+
+    /** @brief Bytes exchanged with the DS1307 over TWI. */
+    uint32_t twi_bytes;
+
+    /** @brief Bytes (physically) written to the EEPROM. */
+    uint32_t ee_writes;
+} SimStats;
+
+/**
+* @brief Wrapper of the firmware's @c main() (see the makefile).
+*/
+int mcu_main();
+
+/** @name Vectors
+* @brief Interrupt Service Routines of the firmware (see avr/io.h).
+* @{
+*/
+void sim_vect_INT1();
+void sim_vect_PCINT1();
+void sim_vect_WDT();
+void sim_vect_TIMER0_COMPA();
+/** @} */
+
+/**
+* @brief Resets all peripherals to their power-on state.
+*
+* Must be called before mcu_main().
+*/
+void sim_init();
+
+/**
+* @brief Sets the function to call whenever the firmware puts the CPU to sleep.
+*
+* This is where the host injects events and calls sim_service() to have them
+* serviced. Once the hook returns, the firmware resumes its main loop, handling
+* the events the ISRs have posted. Without a hook, the process exits the first
+* time the CPU goes to sleep.
+*/
+void sim_set_idle_hook(void (*hook)());
+
+/**
+* @brief Calls the ISRs of pending interrupts, as the CPU would.
+*
+* These are the (level-triggered) @c INT1 of the W5100, the @c WDT (see
+* sim_sleep_ns()) and those of the motors. There is no model of the mechanics:
+* any motion completes at once, either on its step count (@c TIMER0_COMPA) or,
+* while resetting, on the limit switch of the axis it drives (@c PCINT1). It is
+* also called by @c sei() and before going to sleep.
+*
+* The ISRs of the firmware only post events (see event.h); these are handled
+* once the main loop is resumed, or by calling evt_dispatch().
+*
+* @returns The amount of ISRs called.
+*/
+uint8_t sim_service();
+
+/**
+* @brief Simulated time since sim_init(), in nanoseconds.
+*/
+uint64_t sim_clock_ns();
+
+/**
+* @brief Cycles of the CPU clock spent in busy-wait delays and bus transfers
+* since sim_init(), at the frequency of the time.
+*
+* Like sim_clock_ns(), this only accounts for delays and bus transfers. The
+* instructions of the firmware are not counted, so this is not a count of CPU
+* cycles; work that only saves instructions does not show in it.
+*/
+uint64_t sim_bus_cycles();
+
+/**
+* @brief Current CPU frequency, as configured by @c CLKPR.
+*/
+uint32_t sim_f_cpu();
+
+/**
+* @brief Advances the simulated clock by @p ns nanoseconds.
+*/
+void sim_advance_ns(uint64_t ns);
+
+/**
+* @brief Advances the simulated clock by @p ns nanoseconds the CPU sleeps for.
+*
+* Only this time clocks the watchdog, so that its interrupt (every 8s) does not
+* disturb measurements of busy time.
+*/
+void sim_sleep_ns(uint64_t ns);
+
+/**
+* @brief Nanoseconds of sleep until the next watchdog interrupt.
+*
+* @returns @c UINT64_MAX if the watchdog interrupt is disabled.
+*/
+uint64_t sim_wdt_ns();
+
+/**
+* @brief Returns the bus traffic counters.
+*/
+const SimStats* sim_stats();
+
+/** @name W5100
+* @{
+*/
+
+/**
+* @brief Resets the W5100 to its power-on state.
+*/
+void sim_net_reset();
+
+/**
+* @brief Exchanges one SPI byte with the W5100.
+*
+* @param[in] first Non-zero if this is the first byte since @c nCS was pulled
+*   low.
+*/
+uint8_t sim_net_spi(uint8_t byte, uint8_t first);
+
+/**
+* @brief Sets the destination of data sent through @c SEND commands.
+*/
+void sim_net_set_sink(SimNetSink sink);
+
+/**
+* @brief Establishes a connection on socket @p s, if it is listening.
+*
+* @returns @c 0 on success; @c -1, otherwise.
+*/
+int8_t sim_net_accept(uint8_t s);
+
+/**
+* @brief Delivers @p len bytes from the peer of socket @p s.
+*
+* @returns The amount of bytes stored; it is limited by the free space of the
+* socket's Rx buffer.
+*/
+uint16_t sim_net_receive(uint8_t s, const uint8_t* buf, uint16_t len);
+
+/**
+* @brief The peer of socket @p s closes the connection (FIN).
+*/
+void sim_net_close(uint8_t s);
+
+/**
+* @brief The connection of socket @p s times out.
+*/
+void sim_net_timeout(uint8_t s);
+
+/**
+* @brief The peer of socket @p s stops reading, until the socket is opened anew.
+*
+* Data sent from then on stay in the Tx buffer of the socket, which fills up,
+* and no @c SEND completes.
+*/
+void sim_net_stall(uint8_t s);
+
+/**
+* @brief Returns the status register (@c Sn_SR) of socket @p s.
+*/
+uint8_t sim_net_status(uint8_t s);
+
+/**
+* @brief Returns the source port (@c Sn_PORT) of socket @p s.
+*/
+uint16_t sim_net_port(uint8_t s);
+
+/**
+* @brief Returns the free space of the Rx buffer of socket @p s.
+*/
+uint16_t sim_net_rx_free(uint8_t s);
+
+/**
+* @brief Non-zero if the W5100 asserts its interrupt line.
+*/
+uint8_t sim_net_irq();
+/** @} */
+
+/** @name 25LC1024
+* @{
+*/
+
+/**
+* @brief Resets the Flash to its power-on state; contents are preserved.
+*/
+void sim_fls_reset();
+
+/**
+* @brief Exchanges one SPI byte with the Flash.
+*/
+uint8_t sim_fls_spi(uint8_t byte, uint8_t first);
+
+/**
+* @brief Completes the command in progress; called when @c nCS is released.
+*/
+void sim_fls_release();
+
+/**
+* @brief Stores @p len bytes at @p addr, bypassing the SPI interface.
+*/
+void sim_fls_load(uint32_t addr, const uint8_t* buf, uint32_t len);
+
+/**
+* @brief Stores the contents of file @p path at @p addr.
+*
+* The UI assets are loaded this way: @c pack lays them out, along with their
+* directory, in an image of the Flash to be stored at address @c 0 (see
+* pack.c).
+*
+* @returns The size of the file or @c -1, if it could not be read.
+*/
+int32_t sim_fls_load_file(uint32_t addr, const char* path);
+/** @} */
+
+/** @name DS1307
+* @{
+*/
+
+/**
+* @brief Resets the RTC; the clock is halted and the RAM cleared.
+*/
+void sim_rtc_reset();
+
+/**
+* @brief Sets the RTC to @p t (seconds since the Epoch, UTC) and starts it.
+*/
+void sim_rtc_start(int64_t t);
+
+/**
+* @brief A @c START condition has been transmitted.
+*/
+void sim_rtc_start_cond();
+
+/**
+* @brief The address byte @p sla has been transmitted.
+*
+* @returns Non-zero if the RTC acknowledges it.
+*/
+uint8_t sim_rtc_address(uint8_t sla);
+
+/**
+* @brief Writes @p byte at the register pointer (or sets it, if first).
+*/
+void sim_rtc_write(uint8_t byte);
+
+/**
+* @brief Reads the byte at the register pointer.
+*/
+uint8_t sim_rtc_read();
+
+/**
+* @brief A @c STOP condition has been transmitted.
+*/
+void sim_rtc_stop_cond();
+/** @} */
+
+/** @name EEPROM
+* @{
+*/
+
+/**
+* @brief Loads the initial values of the @c EEMEM variables; the rest of the
+* memory is erased (@c 0xFF).
+*/
+void sim_ee_reset();
+
+/**
+* @brief Direct access to the EEPROM contents.
+*/
+uint8_t* sim_ee_mem();
+/** @} */
+
+/** @name Profiler
+* @brief Per-function counters of a firmware built with
+* @c -finstrument-functions (see sim_prof.c).
+* @{
+*/
+
+/**
+* @brief Non-zero if the firmware calls the profiler hooks.
+*/
+uint8_t sim_prof_enabled();
+
+/**
+* @brief Clears the counters of all functions.
+*/
+void sim_prof_reset();
+
+/**
+* @brief Prints the counters of the functions called since sim_prof_reset().
+*
+* Functions are listed by their inclusive bus and delay cycles (see
+* sim_bus_cycles()), each value divided by @p runs. Only the first @p max are
+* printed, if non-zero.
+*/
+void sim_prof_report(FILE* out, uint32_t runs, uint16_t max);
+/** @} */
+
+/**
+* @brief Counters shared among the models.
+*
+* Only to be modified by the simulator itself.
+*/
+extern SimStats sim_stats_data;
+
+/** @} */
+
+#endif /* SIM_H_INCL */
@@ -0,0 +1,121 @@
+#include "sim.h"
+
+#include <avr/eeprom.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+* @brief Bounds of the section holding the @c EEMEM variables (see
+* avr/eeprom.h); provided by the linker.
+*/
+extern uint8_t __start_sim_eeprom[] __attribute__((weak));
+extern uint8_t __stop_sim_eeprom[]  __attribute__((weak));
+
+/**
+* @brief Contents of the EEPROM.
+*/
+static uint8_t mem[SIM_EE_SIZE];
+
+/**
+* @brief Erase and write time of a single byte, in ns. *Atmel p.21*
+*/
+#define SIM_EE_T_WRITE      3400000ULL
+
+/**
+* @brief Maps an EEPROM address, as the firmware uses it, onto #mem.
+*
+* @c EEMEM variables are mapped by their offset within their section, so that
+* they occupy the lowest addresses as on the target; any other value is taken to
+* be an EEPROM offset itself.
+*/
+static uint16_t ee_addr(const void* p) {
+    uintptr_t a =  (uintptr_t)p;
+
+    if(p >= (void*)__start_sim_eeprom && p < (void*)__stop_sim_eeprom) {
+        a  -=  (uintptr_t)__start_sim_eeprom;
+    }
+    if(a >= SIM_EE_SIZE) {
+        fprintf(stderr, "sim: EEPROM address %p out of range\n", p);
+        abort();
+    }
+    return a;
+}
+
+static void ee_write(uint16_t a, uint8_t value) {
+    mem[a]  =  value;
+    ++sim_stats_data.ee_writes;
+    sim_advance_ns(SIM_EE_T_WRITE);
+}
+
+void sim_ee_reset() {
+    size_t len  =  __stop_sim_eeprom - __start_sim_eeprom;
+
+    memset(mem, 0xFF, sizeof(mem));
+    if(__start_sim_eeprom && len <= SIM_EE_SIZE) {
+        memcpy(mem, __start_sim_eeprom, len);
+    }
+}
+
+uint8_t* sim_ee_mem() {
+    return mem;
+}
+
+uint8_t eeprom_read_byte(const uint8_t* addr) {
+    return mem[ee_addr(addr)];
+}
+
+uint16_t eeprom_read_word(const uint16_t* addr) {
+    uint16_t a  =  ee_addr(addr);
+    return mem[a] | ((uint16_t)mem[(a + 1) % SIM_EE_SIZE] << 8);
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n) {
+    uint16_t a  =  ee_addr(src);
+    size_t   i;
+
+    for(i = 0 ; i < n ; ++i) {
+        ((uint8_t*)dst)[i]  =  mem[(a + i) % SIM_EE_SIZE];
+    }
+}
+
+void eeprom_write_byte(uint8_t* addr, uint8_t value) {
+    ee_write(ee_addr(addr), value);
+}
+
+void eeprom_write_word(uint16_t* addr, uint16_t value) {
+    uint16_t a  =  ee_addr(addr);
+    ee_write(a, value);
+    ee_write((a + 1) % SIM_EE_SIZE, value >> 8);
+}
+
+void eeprom_write_block(const void* src, void* dst, size_t n) {
+    uint16_t a  =  ee_addr(dst);
+    size_t   i;
+
+    for(i = 0 ; i < n ; ++i) {
+        ee_write((a + i) % SIM_EE_SIZE, ((const uint8_t*)src)[i]);
+    }
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value) {
+    uint16_t a  =  ee_addr(addr);
+    if(mem[a] != value) ee_write(a, value);
+}
+
+void eeprom_update_word(uint16_t* addr, uint16_t value) {
+    eeprom_update_byte((uint8_t*)addr, value);
+    eeprom_update_byte((uint8_t*)addr + 1, value >> 8);
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n) {
+    uint16_t a  =  ee_addr(dst);
+    size_t   i;
+
+    for(i = 0 ; i < n ; ++i) {
+        uint16_t b  =  (a + i) % SIM_EE_SIZE;
+        uint8_t  v  =  ((const uint8_t*)src)[i];
+        if(mem[b] != v) ee_write(b, v);
+    }
+}
@@ -0,0 +1,210 @@
+#include "sim.h"
+
+#include "defs.h"
+#include "flash.h"
+
+#include <avr/io.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+* @brief Contents of the 25LC1024.
+*/
+static uint8_t mem[SIM_FLS_SIZE];
+
+/**
+* @brief Status register; only the non-volatile bits (@c BP1:0, @c WPEN).
+*/
+static uint8_t status;
+
+/**
+* @brief Write-enable latch.
+*/
+static uint8_t wel;
+
+/**
+* @brief Simulated time at which the internal write cycle completes.
+*/
+static uint64_t busy_until;
+
+/**
+* @brief Non-zero while in Deep Power-Down mode.
+*/
+static uint8_t dpd;
+
+/**
+* @brief Command, address and progress of the exchange in progress.
+*/
+static uint8_t  cmd;
+static uint32_t addr;
+static uint32_t pos;
+
+/** @brief Page write cycle time (T_{WC}), in ns. *25LC1024 p.3* */
+#define SIM_FLS_T_WC        6000000ULL
+
+/** @brief Sector and Chip Erase cycle time, in ns. *25LC1024 p.3* */
+#define SIM_FLS_T_ERASE     10000000ULL
+
+static uint8_t is_busy() {
+    return sim_clock_ns() < busy_until;
+}
+
+/**
+* @brief Non-zero if @p a lies in a sector protected through @c BP1:0.
+*/
+static uint8_t is_protected(uint32_t a) {
+    switch((status >> FLS_BP0) & 0x03) {
+        case 1: return a >= 0x18000;
+        case 2: return a >= 0x10000;
+        case 3: return 1;
+    }
+    return 0;
+}
+
+static void erase(uint32_t from, uint32_t len, uint64_t t) {
+    uint32_t a;
+
+    for(a = from ; a < from + len ; ++a) {
+        if(!is_protected(a)) mem[a] = 0xFF;
+    }
+    busy_until  =  sim_clock_ns() + t;
+}
+
+void sim_fls_reset() {
+    static uint8_t erased;
+
+    /* Leaves the factory erased; contents survive later resets. */
+    if(!erased) memset(mem, 0xFF, sizeof(mem));
+    erased      =  1;
+
+    wel         =  0;
+    dpd         =  0;
+    busy_until  =  0;
+    pos         =  0;
+}
+
+uint8_t sim_fls_spi(uint8_t byte, uint8_t first) {
+    uint8_t out =  0xFF;
+
+    if(first) {
+        cmd     =  byte;
+        pos     =  0;
+        addr    =  0;
+    }
+
+    /* Only RDID is accepted in Deep Power-Down mode; and during a write cycle,
+    * only RDSR. */
+    if((dpd && cmd != FLS_RDID) || (is_busy() && cmd != FLS_RDSR)) {
+        ++pos;
+        return out;
+    }
+
+    switch(cmd) {
+        case FLS_READ:
+        case FLS_WRITE:
+        case FLS_PE:
+        case FLS_SE:
+        case FLS_RDID:
+            if(pos >= 1 && pos <= 3) {
+                addr    =  (addr << 8) | byte;
+
+            } else if(pos > 3) {
+                if(cmd == FLS_READ) {
+                    out =  mem[addr & (SIM_FLS_SIZE - 1)];
+                    ++addr;
+
+                } else if(cmd == FLS_WRITE) {
+                    /* Writes wrap around within the page. */
+                    uint32_t a  =  (addr & ~0xFFUL) | ((addr + pos - 4) & 0xFF);
+                    a          &=  SIM_FLS_SIZE - 1;
+                    if(wel && !is_protected(a)) mem[a] = byte;
+
+                } else if(cmd == FLS_RDID) {
+                    out =  0x29;
+                }
+            }
+        break;
+        case FLS_RDSR:
+            if(pos >= 1) {
+                out =  status | (wel ? _BV(FLS_WEL) : 0)
+                              | (is_busy() ? _BV(FLS_WIP) : 0);
+            }
+        break;
+        case FLS_WRSR:
+            if(pos == 1 && wel) {
+                status  =  byte & (_BV(FLS_BP0) | _BV(FLS_BP1) | _BV(FLS_WPEN));
+            }
+        break;
+    }
+    ++pos;
+    return out;
+}
+
+void sim_fls_release() {
+    if(dpd) {
+        if(cmd == FLS_RDID) dpd = 0;
+        return;
+    }
+    if(is_busy()) return;
+
+    switch(cmd) {
+        case FLS_WREN:
+            wel     =  1;
+        break;
+        case FLS_WRDI:
+            wel     =  0;
+        break;
+        case FLS_WRITE:
+            if(wel && pos > 4) {
+                busy_until  =  sim_clock_ns() + SIM_FLS_T_WC;
+            }
+            wel     =  0;
+        break;
+        case FLS_WRSR:
+            if(wel) busy_until = sim_clock_ns() + SIM_FLS_T_WC;
+            wel     =  0;
+        break;
+        case FLS_PE:
+            if(wel && pos >= 4) {
+                erase(addr & (SIM_FLS_SIZE - 1) & ~0xFFUL, 256, SIM_FLS_T_WC);
+            }
+            wel     =  0;
+        break;
+        case FLS_SE:
+            if(wel && pos >= 4) {
+                erase(addr & (SIM_FLS_SIZE - 1) & ~0x7FFFUL, 0x8000,
+                      SIM_FLS_T_ERASE);
+            }
+            wel     =  0;
+        break;
+        case FLS_CE:
+            if(wel) erase(0, SIM_FLS_SIZE, SIM_FLS_T_ERASE);
+            wel     =  0;
+        break;
+        case FLS_DPD:
+            dpd     =  1;
+        break;
+    }
+}
+
+void sim_fls_load(uint32_t a, const uint8_t* buf, uint32_t len) {
+    if(a >= SIM_FLS_SIZE) return;
+    if(len > SIM_FLS_SIZE - a) len = SIM_FLS_SIZE - a;
+    memcpy(&mem[a], buf, len);
+}
+
+int32_t sim_fls_load_file(uint32_t a, const char* path) {
+    uint8_t buf[4096];
+    size_t  len;
+    int32_t total   =  0;
+    FILE*   f       =  fopen(path, "rb");
+
+    if(!f) return -1;
+    while((len = fread(buf, 1, sizeof(buf), f)) > 0) {
+        sim_fls_load(a + total, buf, len);
+        total  +=  len;
+    }
+    fclose(f);
+    return total;
+}
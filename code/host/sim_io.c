@@ -0,0 +1,372 @@
+#include "sim.h"
+
+#include "defs.h"
+#include "motor.h"
+
+#include <avr/io.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Plain registers. */
+volatile uint8_t  sim_SPCR, sim_TWDR, sim_TWSR, sim_TWBR;
+volatile uint8_t  sim_PORTB, sim_PORTC, sim_DDRB, sim_DDRC, sim_DDRD;
+volatile uint8_t  sim_PINB, sim_PINC, sim_PIND;
+volatile uint8_t  sim_TCCR0A, sim_TCCR0B, sim_TCNT0, sim_OCR0A, sim_TIMSK0;
+volatile uint8_t  sim_TCCR1A, sim_TCCR1B, sim_TIMSK1;
+volatile uint16_t sim_TCNT1, sim_OCR1A, sim_OCR1B, sim_ICR1;
+volatile uint8_t  sim_PCICR, sim_PCMSK1, sim_EIMSK, sim_EICRA;
+volatile uint8_t  sim_MCUSR, sim_WDTCSR, sim_CLKPR, sim_SMCR, sim_SREG;
+volatile uint8_t  sim_UCSR0A, sim_UCSR0B, sim_UCSR0C, sim_UDR0;
+volatile uint8_t  sim_UBRR0H, sim_UBRR0L;
+
+SimStats sim_stats_data;
+
+/**
+* @brief Registers behind the accessors of avr/io.h.
+*/
+static volatile uint8_t reg_SPDR, reg_SPSR, reg_TWCR, reg_PORTD, reg_PINC;
+
+/**
+* @brief Limit switches of @c PINC the simulated motors currently hold engaged.
+*/
+static uint8_t lmt_held;
+
+/**
+* @brief Non-zero once the byte written into @c SPDR has been shifted out.
+*
+* Set when @c SPSR is polled after writing @c SPDR and cleared by accessing
+* @c SPDR, as @c SPIF is on the target.
+*/
+static uint8_t spi_done;
+
+/**
+* @brief Bit of #reg_TWCR that the simulator sets to mark a TWI operation as
+* completed.
+*
+* This bit is reserved (always reads zero) on the target, so the firmware never
+* writes it. A @c TWCR with @c TWINT set and this bit clear has just been
+* written by the firmware and the requested operation is still to be performed.
+*/
+#define SIM_TWCR_DONE       1
+
+/**
+* @brief Non-zero while the TWI is in possession of the bus.
+*/
+static uint8_t twi_busy;
+
+/**
+* @brief Non-zero when the next byte to transmit is an address (SLA+R/W).
+*/
+static uint8_t twi_sla;
+
+/**
+* @brief Non-zero if the addressed slave is to be read from.
+*/
+static uint8_t twi_read;
+
+/**
+* @brief @c PORTD as last observed; used to detect @c nCS edges.
+*/
+static uint8_t portd_seen;
+
+/**
+* @brief Bytes exchanged with each SPI device since its @c nCS went low.
+*/
+static uint32_t net_frame, fls_frame;
+
+static uint64_t clock_ns;
+static uint64_t bus_cycles;
+
+/**
+* @brief Sleep time since the last watchdog interrupt.
+*/
+static uint64_t wdt_ns;
+static void (*idle_hook)();
+
+uint64_t sim_clock_ns() {
+    return clock_ns;
+}
+
+uint64_t sim_bus_cycles() {
+    return bus_cycles;
+}
+
+uint32_t sim_f_cpu() {
+    return SIM_F_OSC >> (sim_CLKPR & 0x0F);
+}
+
+void sim_advance_ns(uint64_t ns) {
+    clock_ns       +=  ns;
+    bus_cycles   +=  ns * sim_f_cpu() / 1000000000ULL;
+}
+
+/**
+* @brief Watchdog time-out set by @c WDTCSR: 2K cycles of its 128kHz oscillator
+* (16ms), doubled for each step of the prescaler (@c WDP3..0).
+*/
+static uint64_t wdt_period_ns() {
+    uint8_t wdp =  (sim_WDTCSR & (_BV(WDP2) | _BV(WDP1) | _BV(WDP0)))
+                | ((sim_WDTCSR & _BV(WDP3)) >> 2);
+
+    return 16000000ULL << wdp;
+}
+
+void sim_sleep_ns(uint64_t ns) {
+    sim_advance_ns(ns);
+    wdt_ns     +=  ns;
+}
+
+uint64_t sim_wdt_ns() {
+    if(bit_is_clear(sim_WDTCSR, WDIE)) return UINT64_MAX;
+    return wdt_ns < wdt_period_ns() ? wdt_period_ns() - wdt_ns : 0;
+}
+
+void sim_delay_cycles(uint32_t cycles) {
+    clock_ns       +=  (uint64_t)cycles * 1000000000ULL / sim_f_cpu();
+    bus_cycles   +=  cycles;
+}
+
+const SimStats* sim_stats() {
+    return &sim_stats_data;
+}
+
+/**
+* @brief Observes @c nCS of the W5100 (@c PORTD7) and the Flash (@c PORTD1).
+*/
+static void spi_sync() {
+    uint8_t rising  =  reg_PORTD & ~portd_seen;
+
+    if(rising & _BV(PORTD7)) net_frame = 0;
+    if(rising & _BV(PORTD1)) {
+        if(fls_frame) sim_fls_release();
+        fls_frame   =  0;
+    }
+    portd_seen      =  reg_PORTD;
+}
+
+/**
+* @brief Shifts #reg_SPDR out to the selected device and its response in.
+*/
+static void spi_transfer() {
+    static const uint8_t divider[] = {4, 16, 64, 128};
+    uint8_t  in     =  0xFF;
+    uint32_t div    =  divider[sim_SPCR & (_BV(SPR1) | _BV(SPR0))];
+
+    if(reg_SPSR & _BV(SPI2X)) div >>= 1;
+
+    spi_sync();
+    if(bit_is_clear(reg_PORTD, PORTD7)) {
+        in  =  sim_net_spi(reg_SPDR, net_frame == 0);
+        ++net_frame;
+        ++sim_stats_data.net_bytes;
+
+    } else if(bit_is_clear(reg_PORTD, PORTD1)) {
+        in  =  sim_fls_spi(reg_SPDR, fls_frame == 0);
+        ++fls_frame;
+        ++sim_stats_data.fls_bytes;
+    }
+
+    reg_SPDR    =  in;
+    sim_delay_cycles(8 * div);
+}
+
+volatile uint8_t* sim_reg_SPDR() {
+    spi_done    =  0;
+    reg_SPSR   &= ~_BV(SPIF);
+    return &reg_SPDR;
+}
+
+volatile uint8_t* sim_reg_SPSR() {
+    if(!spi_done && bit_is_set(sim_SPCR, SPE)) {
+        spi_transfer();
+        spi_done    =  1;
+    }
+    if(spi_done) {
+        reg_SPSR   |=  _BV(SPIF);
+    } else {
+        reg_SPSR   &= ~_BV(SPIF);
+    }
+    return &reg_SPSR;
+}
+
+volatile uint8_t* sim_reg_PORTD() {
+    spi_sync();
+    return &reg_PORTD;
+}
+
+volatile uint8_t* sim_reg_PINC() {
+    uint8_t held    =  lmt_held;
+
+    /* Backtracking disengages the switch (see #BCK_XZ and #BCK_Y). */
+    if(bit_is_set(reg_PORTD, BCK_XZ)) held &= ~_BV(LMT_nXZ);
+    if(bit_is_set(sim_PORTB, BCK_Y))  held &= ~_BV(LMT_nY);
+
+    /* Both switches are normally closed; their pins idle high. */
+    reg_PINC    =  (sim_PINC | _BV(LMT_nXZ) | _BV(LMT_nY)) & ~held;
+    return &reg_PINC;
+}
+
+/**
+* @brief Performs the operation last written into @c TWCR.
+*/
+static void twi_operate() {
+    uint8_t  status;
+    uint32_t scl    =  sim_f_cpu() / (16 + 2 * (uint32_t)sim_TWBR
+                                         * (1 << ((sim_TWSR & 0x03) * 2)));
+
+    if(bit_is_set(reg_TWCR, TWSTO)) {
+        if(twi_busy) sim_rtc_stop_cond();
+        twi_busy    =  0;
+
+        /* No further interrupt follows a STOP condition. */
+        reg_TWCR   &= ~(_BV(TWSTO) | _BV(TWINT));
+        return;
+    }
+
+    if(bit_is_set(reg_TWCR, TWSTA)) {
+        status      =  twi_busy ? 0x10 : 0x08;
+        twi_busy    =  1;
+        twi_sla     =  1;
+        sim_rtc_start_cond();
+
+    } else if(twi_sla) {
+        twi_read    =  sim_TWDR & 1;
+        twi_sla     =  0;
+        if(sim_rtc_address(sim_TWDR)) {
+            status  =  twi_read ? 0x40 : 0x18;
+        } else {
+            status  =  twi_read ? 0x48 : 0x20;
+        }
+
+    } else if(twi_read) {
+        sim_TWDR    =  sim_rtc_read();
+        status      =  bit_is_set(reg_TWCR, TWEA) ? 0x50 : 0x58;
+
+    } else {
+        sim_rtc_write(sim_TWDR);
+        status      =  0x28;
+    }
+
+    ++sim_stats_data.twi_bytes;
+    sim_advance_ns(9ULL * 1000000000ULL / (scl ? scl : 1));
+
+    sim_TWSR    =  status | (sim_TWSR & 0x03);
+    reg_TWCR   &= ~_BV(TWSTA);
+    reg_TWCR   |=  _BV(TWINT) | _BV(SIM_TWCR_DONE);
+}
+
+volatile uint8_t* sim_reg_TWCR() {
+    if(bit_is_set(reg_TWCR, TWSTO)
+    || (bit_is_set(reg_TWCR, TWINT) && bit_is_clear(reg_TWCR, SIM_TWCR_DONE))) {
+        twi_operate();
+    }
+    return &reg_TWCR;
+}
+
+void sim_init() {
+    reg_PORTD    =  0;
+    portd_seen   =  0;
+    spi_done     =  0;
+    twi_busy     =  0;
+    lmt_held     =  0;
+    clock_ns     =  0;
+    bus_cycles =  0;
+    wdt_ns       =  0;
+    memset(&sim_stats_data, 0, sizeof(sim_stats_data));
+
+    sim_net_reset();
+    sim_fls_reset();
+    sim_rtc_reset();
+    sim_ee_reset();
+}
+
+void sim_set_idle_hook(void (*hook)()) {
+    idle_hook   =  hook;
+}
+
+void sim_sleep() {
+    /* An interrupt pending as the CPU goes to sleep wakes it at once. */
+    if(sim_service()) return;
+
+    if(!idle_hook) exit(0);
+    (*idle_hook)();
+}
+
+void sim_sei() {
+    sim_SREG   |=  0x80;
+
+    /* The instruction following @c sei is executed before any interrupt; when
+    * about to sleep, that is @c sleep itself (see sim_sleep()). */
+    if(bit_is_clear(sim_SMCR, SE)) sim_service();
+}
+
+/**
+* @brief Returns the ISR the motors request, if any.
+*
+* Motion completes as soon as it is requested: a counted move (step counter
+* clocked by the encoders) reaches its compare match, while an uncounted one,
+* ie, resetting, runs into the limit switch of the axis it drives. The latter
+* is held engaged in #lmt_held for the duration of the ISR.
+*/
+static void (*motor_event())() {
+    if(!(sim_TCCR1B & (_BV(CS12) | _BV(CS11) | _BV(CS10)))) return NULL;
+
+    if((sim_TCCR0B & (_BV(CS02) | _BV(CS01) | _BV(CS00)))
+    &&  bit_is_set(sim_TCCR0A, WGM01)) {
+        if(bit_is_clear(sim_TIMSK0, OCIE0A)) return NULL;
+
+        sim_TCNT0   =  sim_OCR0A;
+        return &sim_vect_TIMER0_COMPA;
+    }
+
+    if(bit_is_clear(sim_PCICR, PCIE1)) return NULL;
+
+    if(sim_OCR1B && sim_OCR1B != MTR_BRAKE) {
+        lmt_held    =  _BV(LMT_nXZ);
+    } else if(sim_OCR1A && sim_OCR1A != MTR_BRAKE) {
+        lmt_held    =  _BV(LMT_nY);
+    } else {
+        return NULL;
+    }
+    return &sim_vect_PCINT1;
+}
+
+uint8_t sim_service() {
+    void   (*isr)();
+    uint8_t guard   =  16;
+    uint8_t taken   =  0;
+
+    while(bit_is_set(sim_SREG, 7) && guard--) {
+
+        /* INT1 is level-triggered; the ISR runs for as long as it is
+        * asserted. */
+        if(bit_is_set(sim_EIMSK, INT1) && sim_net_irq()) {
+            isr     =  &sim_vect_INT1;
+        } else if(sim_wdt_ns() == 0) {
+            wdt_ns  =  0;
+            isr     =  &sim_vect_WDT;
+        } else if(!(isr = motor_event())) {
+            break;
+        }
+
+        sim_SREG   &= ~0x80;
+        (*isr)();
+        sim_SREG   |=  0x80;
+        lmt_held    =  0;
+        ++taken;
+    }
+    return taken;
+}
+
+char* strupr(char* s) {
+    char* c;
+    for(c = s ; *c ; ++c) *c = toupper((unsigned char)*c);
+    return s;
+}
+
+char* strlwr(char* s) {
+    char* c;
+    for(c = s ; *c ; ++c) *c = tolower((unsigned char)*c);
+    return s;
+}
@@ -0,0 +1,209 @@
+/**
+* @file
+* @brief Function profiler of the host build.
+*
+* When the firmware is built with @c -finstrument-functions (see the @c profile
+* target of the makefile), each of its functions calls the hooks below on entry
+* and exit. For every function they count the calls and accumulate, inclusive of
+* its callees, the bus and delay cycles (sim_bus_cycles(); instructions are not
+* counted) and the host time spent in it.
+* Recursive calls are only accounted for on the outermost one.
+*
+* Names are resolved when reporting, through @c nm on the executable, so that
+* static functions (such as log_find()) are listed as well.
+*/
+
+#include "sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+* @brief Size of the function table; a power of two.
+*/
+#define PROF_SLOTS          1024
+
+/**
+* @brief Counters of a function.
+*/
+typedef struct {
+    void*    fn;
+    uint32_t calls;
+    uint32_t depth;
+    uint64_t cycles;
+    uint64_t ns;
+    uint64_t cycles_in;     /* At the outermost entry. */
+    uint64_t ns_in;
+} ProfEntry;
+
+static ProfEntry table[PROF_SLOTS];
+
+/**
+* @brief Non-zero once any hook has been called.
+*/
+static uint8_t enabled;
+
+void __cyg_profile_func_enter(void* fn, void* site);
+void __cyg_profile_func_exit(void* fn, void* site);
+
+static uint64_t now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/**
+* @brief Returns the entry of @p fn, claiming a free one if it has none.
+*
+* @returns @c NULL if the table is full.
+*/
+static ProfEntry* prof_find(void* fn) {
+    uint32_t i  =  ((uintptr_t)fn >> 4) & (PROF_SLOTS - 1);
+    uint32_t n;
+
+    for(n = 0 ; n < PROF_SLOTS ; ++n, i = (i + 1) & (PROF_SLOTS - 1)) {
+        if(table[i].fn == fn) return &table[i];
+        if(!table[i].fn) {
+            table[i].fn =  fn;
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+void __cyg_profile_func_enter(void* fn, void* site) {
+    ProfEntry* e    =  prof_find(fn);
+
+    enabled =  1;
+    if(!e) return;
+
+    ++e->calls;
+    if(e->depth++ == 0) {
+        e->cycles_in    =  sim_bus_cycles();
+        e->ns_in        =  now_ns();
+    }
+}
+
+void __cyg_profile_func_exit(void* fn, void* site) {
+    ProfEntry* e    =  prof_find(fn);
+
+    if(!e || !e->depth) return;
+
+    if(--e->depth == 0) {
+        e->cycles      +=  sim_bus_cycles() - e->cycles_in;
+        e->ns          +=  now_ns() - e->ns_in;
+    }
+}
+
+uint8_t sim_prof_enabled() {
+    return enabled;
+}
+
+void sim_prof_reset() {
+    uint32_t i;
+
+    for(i = 0 ; i < PROF_SLOTS ; ++i) {
+        table[i].calls  =  0;
+        table[i].cycles =  0;
+        table[i].ns     =  0;
+
+        /* Functions in progress keep being timed from now on. */
+        if(table[i].depth) {
+            table[i].cycles_in  =  sim_bus_cycles();
+            table[i].ns_in      =  now_ns();
+        }
+    }
+}
+
+/**
+* @brief Copies the name of the function at @p fn into @p name.
+*
+* The symbols of the executable are read once, through @c nm, and relocated by
+* the address of this very function.
+*/
+static void prof_name(void* fn, char* name, size_t len) {
+    typedef struct { uintptr_t addr; char name[64]; } Symbol;
+
+    static Symbol*   syms;
+    static size_t    count;
+    static uint8_t   loaded;
+    static intptr_t  bias;
+    size_t           i;
+
+    if(!loaded) {
+        char  cmd[600];
+        char  exe[512];
+        char  line[256];
+        FILE* p;
+        ssize_t n   =  readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+
+        loaded  =  1;
+        if(n > 0) {
+            exe[n]  =  '\0';
+            snprintf(cmd, sizeof(cmd), "nm --defined-only '%s' 2>/dev/null",
+                     exe);
+            p   =  popen(cmd, "r");
+
+            while(p && fgets(line, sizeof(line), p)) {
+                unsigned long addr;
+                char          type;
+                Symbol*       more;
+
+                more    =  realloc(syms, (count + 1) * sizeof(Symbol));
+                if(!more) break;
+                syms    =  more;
+                if(sscanf(line, "%lx %c %63s", &addr, &type,
+                          syms[count].name) != 3) continue;
+                if(type != 't' && type != 'T') continue;
+
+                syms[count].addr    =  addr;
+                if(!strcmp(syms[count].name, "sim_prof_report")) {
+                    bias    =  (intptr_t)&sim_prof_report - (intptr_t)addr;
+                }
+                ++count;
+            }
+            if(p) pclose(p);
+        }
+    }
+
+    for(i = 0 ; i < count ; ++i) {
+        if(syms[i].addr + bias == (uintptr_t)fn) {
+            snprintf(name, len, "%s", syms[i].name);
+            return;
+        }
+    }
+    snprintf(name, len, "%p", fn);
+}
+
+static int prof_cmp(const void* a, const void* b) {
+    const ProfEntry* x = *(const ProfEntry* const*)a;
+    const ProfEntry* y = *(const ProfEntry* const*)b;
+
+    if(x->cycles != y->cycles) return x->cycles < y->cycles ? 1 : -1;
+    return (x->ns < y->ns) - (x->ns > y->ns);
+}
+
+void sim_prof_report(FILE* out, uint32_t runs, uint16_t max) {
+    ProfEntry* list[PROF_SLOTS];
+    uint32_t   n    =  0;
+    uint32_t   i;
+    char       name[64];
+
+    if(!runs) runs = 1;
+
+    for(i = 0 ; i < PROF_SLOTS ; ++i) {
+        if(table[i].fn && table[i].calls) list[n++] = &table[i];
+    }
+    qsort(list, n, sizeof(ProfEntry*), prof_cmp);
+    if(max && n > max) n = max;
+
+    for(i = 0 ; i < n ; ++i) {
+        prof_name(list[i]->fn, name, sizeof(name));
+        fprintf(out, "  %-30s %9.1f %11.1f %9.2f\n", name,
+                list[i]->calls / (double)runs,
+                list[i]->cycles / (double)runs,
+                list[i]->ns / (double)runs / 1000.0);
+    }
+}
@@ -0,0 +1,141 @@
+#include "sim.h"
+
+#include "rtc.h"
+
+#include <avr/io.h>
+
+#include <string.h>
+#include <time.h>
+
+/**
+* @brief Clock registers (@c 0x00--@c 0x07) and RAM (@c 0x08--@c 0x3F).
+*/
+static uint8_t mem[64];
+
+/**
+* @brief Register pointer.
+*/
+static uint8_t ptr;
+
+/**
+* @brief Non-zero if the next byte written sets #ptr.
+*/
+static uint8_t expect_ptr;
+
+/**
+* @brief Non-zero if any clock register was written during this transfer.
+*/
+static uint8_t clock_written;
+
+/**
+* @brief Time (seconds since the Epoch) the clock registers held at
+* #set_at_ns.
+*/
+static int64_t epoch;
+
+/**
+* @brief Simulated time at which the clock was last set.
+*/
+static uint64_t set_at_ns;
+
+static uint8_t to_bcd(int v) {
+    return ((v / 10) << 4) | (v % 10);
+}
+
+static int from_bcd(uint8_t v) {
+    return (v >> 4) * 10 + (v & 0x0F);
+}
+
+/**
+* @brief Loads the current time into the clock registers, unless halted.
+*
+* As the DS1307 does, the registers are latched on each @c START condition.
+*/
+static void latch() {
+    time_t    t;
+    struct tm tm;
+
+    if(bit_is_set(mem[0], RTC_CH)) return;
+
+    t   =  epoch + (sim_clock_ns() - set_at_ns) / 1000000000ULL;
+    gmtime_r(&t, &tm);
+
+    mem[0]  =  to_bcd(tm.tm_sec);
+    mem[1]  =  to_bcd(tm.tm_min);
+    mem[2]  =  to_bcd(tm.tm_hour);
+    mem[3]  =  tm.tm_wday + 1;
+    mem[4]  =  to_bcd(tm.tm_mday);
+    mem[5]  =  to_bcd(tm.tm_mon + 1);
+    mem[6]  =  to_bcd(tm.tm_year % 100);
+}
+
+/**
+* @brief Restarts counting from the time now held in the clock registers.
+*/
+static void set_clock() {
+    struct tm tm;
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_sec   =  from_bcd(mem[0] & 0x7F);
+    tm.tm_min   =  from_bcd(mem[1]);
+    tm.tm_hour  =  from_bcd(mem[2] & 0x3F);
+    tm.tm_mday  =  from_bcd(mem[4]);
+    tm.tm_mon   =  from_bcd(mem[5]) - 1;
+    tm.tm_year  =  from_bcd(mem[6]) + 100;
+
+    epoch       =  timegm(&tm);
+    set_at_ns   =  sim_clock_ns();
+}
+
+void sim_rtc_reset() {
+    /* The oscillator is halted upon first power application; the date is
+    * 01/01/00, a Saturday. *DS1307 p.8* */
+    memset(mem, 0, sizeof(mem));
+    mem[0]      =  _BV(RTC_CH);
+    mem[3]      =  0x01;
+    mem[4]      =  0x01;
+    mem[5]      =  0x01;
+    ptr         =  0;
+    set_clock();
+}
+
+void sim_rtc_start(int64_t t) {
+    epoch       =  t;
+    set_at_ns   =  sim_clock_ns();
+    mem[0]     &= ~_BV(RTC_CH);
+    latch();
+}
+
+void sim_rtc_start_cond() {
+    latch();
+}
+
+uint8_t sim_rtc_address(uint8_t sla) {
+    if((sla & 0xFE) != RTC_ADDR) return 0;
+
+    expect_ptr  =  !(sla & 1);
+    return 1;
+}
+
+void sim_rtc_write(uint8_t byte) {
+    if(expect_ptr) {
+        ptr         =  byte & 0x3F;
+        expect_ptr  =  0;
+        return;
+    }
+
+    if(ptr < 7) clock_written = 1;
+    mem[ptr]    =  byte;
+    ptr         =  (ptr + 1) & 0x3F;
+}
+
+uint8_t sim_rtc_read() {
+    uint8_t byte    =  mem[ptr];
+    ptr             =  (ptr + 1) & 0x3F;
+    return byte;
+}
+
+void sim_rtc_stop_cond() {
+    if(clock_written) set_clock();
+    clock_written   =  0;
+}
@@ -0,0 +1,322 @@
+#include "sim.h"
+
+#include "w5100.h"
+
+#include <avr/io.h>
+
+#include <string.h>
+
+/**
+* @brief Register and buffer memory of the W5100 (@c 0x0000--@c 0x7FFF).
+*/
+static uint8_t mem[SIM_NET_MEM_SIZE];
+
+/**
+* @brief Total bytes received per socket; the Rx write pointer.
+*
+* @c Sn_RX_RSR is this value minus @c Sn_RX_RR.
+*/
+static uint16_t rx_wr[4];
+
+/**
+* @brief Opcode and address of the SPI frame in progress.
+*/
+static uint8_t  frame_op;
+static uint16_t frame_addr;
+static uint8_t  frame_pos;
+
+static SimNetSink sink;
+
+/**
+* @brief Sockets whose peer has stopped reading; a bit per socket.
+*
+* Set by sim_net_stall() and cleared by @c OPEN.
+*/
+static uint8_t stalled;
+
+static uint16_t get16(uint16_t addr) {
+    return ((uint16_t)mem[addr] << 8) | mem[addr + 1];
+}
+
+static void set16(uint16_t addr, uint16_t value) {
+    mem[addr]       =  value >> 8;
+    mem[addr + 1]   =  value;
+}
+
+/**
+* @brief Buffer size of socket @p s, as set in @c TMSR (or @c RMSR).
+*/
+static uint16_t buf_size(uint8_t msr, uint8_t s) {
+    return 1024 << ((msr >> (s * 2)) & 0x03);
+}
+
+/**
+* @brief Buffer base address of socket @p s (past the preceding sockets).
+*/
+static uint16_t buf_base(uint16_t base, uint8_t msr, uint8_t s) {
+    uint8_t i;
+    for(i = 0 ; i < s ; ++i) base += buf_size(msr, i);
+    return base;
+}
+
+static void update_rsr(uint8_t s) {
+    set16(NET_Sn_RX_RSR(s), rx_wr[s] - get16(NET_Sn_RX_RR(s)));
+}
+
+/**
+* @brief Hands the data between @c Sn_TX_RR and @c Sn_TX_WR over to the sink.
+*/
+static void send(uint8_t s) {
+    uint8_t  out[8192];
+    uint16_t size   =  buf_size(mem[NET_TMSR], s);
+    uint16_t base   =  buf_base(NET_TX_BASE, mem[NET_TMSR], s);
+    uint16_t rr     =  get16(NET_Sn_TX_RR(s));
+    uint16_t len    =  get16(NET_Sn_TX_WR(s)) - rr;
+    uint16_t i;
+
+    if(len > size) len = size;
+
+    /* Nothing is taken; what is sent occupies the buffer. */
+    if(stalled & _BV(s)) {
+        set16(NET_Sn_TX_FSR(s), size - len);
+        return;
+    }
+    for(i = 0 ; i < len ; ++i) {
+        out[i]  =  mem[base + ((rr + i) & (size - 1))];
+    }
+
+    set16(NET_Sn_TX_RR(s), rr + len);
+    set16(NET_Sn_TX_FSR(s), size);
+
+    if(mem[NET_Sn_SR(s)] == NET_Sn_SR_ESTAB
+    || mem[NET_Sn_SR(s)] == NET_Sn_SR_CLOSEWAIT) {
+        if(sink && len) (*sink)(s, out, len);
+        mem[NET_Sn_IR(s)]  |=  _BV(NET_Sn_IR_SEND_OK);
+
+    } else {
+        mem[NET_Sn_SR(s)]   =  NET_Sn_SR_CLOSED;
+        mem[NET_Sn_IR(s)]  |=  _BV(NET_Sn_IR_TIMEOUT);
+    }
+}
+
+/**
+* @brief Executes a socket command (@c Sn_CR).
+*/
+static void command(uint8_t s, uint8_t cmd) {
+    uint8_t* sr     = &mem[NET_Sn_SR(s)];
+
+    switch(cmd) {
+        case NET_Sn_CR_OPEN:
+            if((mem[NET_Sn_MR(s)] & 0x0F) == NET_Sn_MR_TCP) {
+                *sr     =  NET_Sn_SR_INIT;
+                stalled    &= ~_BV(s);
+                set16(NET_Sn_TX_RR(s), 0);
+                set16(NET_Sn_TX_WR(s), 0);
+                set16(NET_Sn_TX_FSR(s), buf_size(mem[NET_TMSR], s));
+                set16(NET_Sn_RX_RR(s), 0);
+                rx_wr[s]    =  0;
+                update_rsr(s);
+            }
+        break;
+        case NET_Sn_CR_LISTEN:
+            if(*sr == NET_Sn_SR_INIT) *sr = NET_Sn_SR_LISTEN;
+
+        break;
+        case NET_Sn_CR_DISCON:
+            /* An active close completes with a DISCON interrupt; a passive one
+            * (in response to the peer's FIN) just ends the connection. */
+            if(*sr == NET_Sn_SR_ESTAB) {
+                mem[NET_Sn_IR(s)]  |=  _BV(NET_Sn_IR_DISCON);
+            }
+            *sr =  NET_Sn_SR_CLOSED;
+
+        break;
+        case NET_Sn_CR_CLOSE:
+            *sr =  NET_Sn_SR_CLOSED;
+
+        break;
+        case NET_Sn_CR_SEND:
+            send(s);
+
+        break;
+        case NET_Sn_CR_RECV:
+            update_rsr(s);
+
+        break;
+    }
+}
+
+/**
+* @brief Reads a byte, as the W5100 presents it.
+*/
+static uint8_t reg_read(uint16_t addr) {
+    uint8_t s;
+
+    if(addr >= SIM_NET_MEM_SIZE) return 0;
+
+    /* Socket bits of IR reflect whether any Sn_IR flag is set. */
+    if(addr == NET_IR) {
+        uint8_t ir  =  mem[NET_IR] & 0xE0;
+        for(s = 0 ; s < 4 ; ++s) {
+            if(mem[NET_Sn_IR(s)]) ir |= NET_IR_Sn(s);
+        }
+        return ir;
+    }
+    return mem[addr];
+}
+
+/**
+* @brief Writes a byte, honouring read-only and write-one-to-clear registers.
+*/
+static void reg_write(uint16_t addr, uint8_t data) {
+    if(addr >= SIM_NET_MEM_SIZE) return;
+
+    if(addr == NET_MR) {
+        if(data & _BV(NET_MR_RST)) {
+            sim_net_reset();
+        } else {
+            mem[addr]   =  data;
+        }
+        return;
+    }
+
+    if(addr == NET_IR) {
+        mem[addr]  &= ~(data & 0xE0);
+        return;
+    }
+
+    if(addr >= NET_Sn_OFFSET(0) && addr < NET_Sn_OFFSET(4)) {
+        uint8_t s   =  (addr - NET_Sn_OFFSET(0)) >> 8;
+        uint8_t reg =  addr & 0xFF;
+
+        switch(reg) {
+            case 0x01:
+                command(s, data);
+                return;
+            case 0x02:
+                mem[addr]  &= ~data;
+                return;
+
+            /* Sn_SR, Sn_TX_FSR, Sn_TX_RR and Sn_RX_RSR are read-only. */
+            case 0x03:
+            case 0x20: case 0x21:
+            case 0x22: case 0x23:
+            case 0x26: case 0x27:
+                return;
+        }
+    }
+    mem[addr]   =  data;
+}
+
+void sim_net_reset() {
+    uint8_t s;
+
+    memset(mem, 0, sizeof(mem));
+    memset(rx_wr, 0, sizeof(rx_wr));
+    stalled         =  0;
+
+    /* Defaults as of *W5100 p.14--22*: RTR 200ms, RCR 8, 2KB per socket. */
+    set16(0x0017, 0x07D0);
+    mem[0x0019]     =  0x08;
+    mem[NET_RMSR]   =  0x55;
+    mem[NET_TMSR]   =  0x55;
+
+    for(s = 0 ; s < 4 ; ++s) {
+        set16(NET_Sn_TX_FSR(s), 2048);
+    }
+    frame_pos       =  0;
+}
+
+uint8_t sim_net_spi(uint8_t byte, uint8_t first) {
+    uint8_t out;
+
+    if(first) frame_pos = 0;
+
+    switch(frame_pos & 0x03) {
+        case 0:
+            frame_op    =  byte;
+            out         =  0x00;
+        break;
+        case 1:
+            frame_addr  =  (uint16_t)byte << 8;
+            out         =  0x01;
+        break;
+        case 2:
+            frame_addr |=  byte;
+            out         =  0x02;
+        break;
+        default:
+            if(frame_op == 0xF0) {
+                reg_write(frame_addr, byte);
+                out     =  0x03;
+            } else {
+                out     =  reg_read(frame_addr);
+            }
+    }
+    ++frame_pos;
+    return out;
+}
+
+void sim_net_set_sink(SimNetSink s) {
+    sink    =  s;
+}
+
+int8_t sim_net_accept(uint8_t s) {
+    if(mem[NET_Sn_SR(s)] != NET_Sn_SR_LISTEN) return -1;
+
+    mem[NET_Sn_SR(s)]   =  NET_Sn_SR_ESTAB;
+    mem[NET_Sn_IR(s)]  |=  _BV(NET_Sn_IR_CON);
+    return 0;
+}
+
+uint16_t sim_net_receive(uint8_t s, const uint8_t* buf, uint16_t len) {
+    uint16_t size   =  buf_size(mem[NET_RMSR], s);
+    uint16_t base   =  buf_base(NET_RX_BASE, mem[NET_RMSR], s);
+    uint16_t used   =  rx_wr[s] - get16(NET_Sn_RX_RR(s));
+    uint16_t i;
+
+    if(mem[NET_Sn_SR(s)] != NET_Sn_SR_ESTAB) return 0;
+
+    if(len > size - used) len = size - used;
+    for(i = 0 ; i < len ; ++i) {
+        mem[base + ((rx_wr[s] + i) & (size - 1))] = buf[i];
+    }
+    rx_wr[s]   +=  len;
+    update_rsr(s);
+
+    if(len) mem[NET_Sn_IR(s)] |= _BV(NET_Sn_IR_RECV);
+    return len;
+}
+
+void sim_net_close(uint8_t s) {
+    if(mem[NET_Sn_SR(s)] != NET_Sn_SR_ESTAB) return;
+
+    mem[NET_Sn_SR(s)]   =  NET_Sn_SR_CLOSEWAIT;
+    mem[NET_Sn_IR(s)]  |=  _BV(NET_Sn_IR_DISCON);
+}
+
+void sim_net_timeout(uint8_t s) {
+    mem[NET_Sn_SR(s)]   =  NET_Sn_SR_CLOSED;
+    mem[NET_Sn_IR(s)]  |=  _BV(NET_Sn_IR_TIMEOUT);
+}
+
+void sim_net_stall(uint8_t s) {
+    stalled    |=  _BV(s);
+}
+
+uint8_t sim_net_status(uint8_t s) {
+    return mem[NET_Sn_SR(s)];
+}
+
+uint16_t sim_net_port(uint8_t s) {
+    return get16(NET_Sn_PORT(s));
+}
+
+uint16_t sim_net_rx_free(uint8_t s) {
+    return buf_size(mem[NET_RMSR], s) - (uint16_t)(rx_wr[s]
+                                                 - get16(NET_Sn_RX_RR(s)));
+}
+
+uint8_t sim_net_irq() {
+    return reg_read(NET_IR) & mem[NET_IMR];
+}
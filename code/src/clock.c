@@ -0,0 +1,57 @@
+#include "clock.h"
+#include "defs.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/**
+* @ingroup clock
+* @brief Non-zero while the clock is at #F_CPU_FAST.
+*/
+static uint8_t clk_is_fast;
+
+/**
+* @ingroup clock
+* @brief Sets the clock prescaler to @p clkps and the rate registers derived
+* from the clock to @p twbr and @p ubrr.
+*/
+static void clk_set(uint8_t clkps, uint8_t twbr, uint16_t ubrr) {
+    uint8_t sreg    =  SREG;
+
+    /* CLKPS3:0 must be written within four cycles of setting CLKPCE alone;
+    * nothing may interrupt in between. *Atmel pp.34--37* */
+    cli();
+    CLKPR       =  _BV(CLKPCE);
+    CLKPR       =  clkps;
+    SREG        =  sreg;
+
+    /* The TWI and the USART are only ever driven by the main loop, which is
+    * where the clock is changed as well; neither is in the middle of a
+    * transfer. */
+    TWBR        =  twbr;
+
+    #ifdef ENABLE_SERIAL_IO
+    UBRR0H      =  (unsigned char)(ubrr >> 8);
+    UBRR0L      =  (unsigned char)(ubrr);
+    #endif /* ENABLE_SERIAL_IO */
+}
+
+int8_t clk_fast() {
+    if(clk_is_fast) return 0;
+
+    /* Timer/Counter1 is clocked while the motors are running. */
+    if(TCCR1B & (_BV(CS12) | _BV(CS11) | _BV(CS10))) return -1;
+
+    /* Divide by 1. */
+    clk_set(0, TWBR_VALUE_FAST, UBRR_VALUE_FAST);
+    clk_is_fast =  1;
+    return 0;
+}
+
+void clk_slow() {
+    if(!clk_is_fast) return;
+
+    /* Divide by 4. */
+    clk_set(_BV(CLKPS1), TWBR_VALUE, UBRR_VALUE);
+    clk_is_fast =  0;
+}
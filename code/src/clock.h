@@ -0,0 +1,48 @@
+/**
+* @file
+* @addtogroup clock Clock
+*
+* @brief Scaling of the system clock with the work at hand.
+*
+* The MCU idles, samples and drives the motors at #F_CPU, a quarter of the
+* crystal frequency. The HTTP requests (and the Flash transfers they entail) are
+* served at #F_CPU_FAST, instead, which quadruples the rate of the SPI bus along
+* with that of the CPU. The bit rate of the TWI and, if enabled, the baud rate
+* of the USART follow the clock, so that the RTC and the serial line are
+* oblivious to it.
+*
+* Whatever else depends on the clock does so at compile time: the motor PWM
+* (#MTR_TOP, #MTR_PRESCALER) and the busy-wait delays of <util/delay.h>. This is
+* why the clock is never raised while the motors are running and the motors
+* lower it before starting. At #F_CPU_FAST, the delays last a quarter of what
+* they were written for; those met in serving a request are the minimum @c nCS
+* timings of the 25LC1024 and the W5100, which are still exceeded by far.
+* Sampling, with its 1-Wire timing, only ever occurs at #F_CPU.
+* @{
+*/
+
+#ifndef CLOCK_H_INCL
+#define CLOCK_H_INCL
+
+#include <inttypes.h>
+
+/**
+* @brief Runs the system clock at #F_CPU_FAST.
+*
+* @returns @c 0, if the clock is (now) at #F_CPU_FAST; @c -1, if the motors are
+*   running, in which case it is left at #F_CPU.
+*/
+int8_t clk_fast();
+
+/**
+* @brief Runs the system clock at #F_CPU; this is also its initial setting.
+*
+* Any callers that depend on #F_CPU should call this first, unless they are
+* known to be reached only from an ISR or a handler other than that of
+* #EVT_NET (see evt_dispatch()).
+*/
+void clk_slow();
+
+/** @} */
+
+#endif /* CLOCK_H_INCL */
@@ -11,8 +11,13 @@
 *
 * Additionally, if @c ENABLE_DEBUG is not defined, provide write-access to the
 * (external) Flash (from the host).
+*
+* Not available when building for the host simulator (@c HOST_BUILD), which has
+* no USART.
 */
+#ifndef HOST_BUILD
 #define ENABLE_SERIAL_IO
+#endif
 
 /**
 * @brief Enable transmissions via the USART and disable writing to the Flash.
@@ -21,6 +26,24 @@
 */
 /* #define ENABLE_DEBUG */
 
+/**
+* @brief Drive the SPI bus by plain polling, one byte at a time.
+*
+* By default, bulk transfers to and from the W5100 and the Flash prepare the
+* next byte (and store the previous one) while the current one is being
+* shifted, so that the bus only idles for the few cycles it takes to notice
+* @c SPIF and reload @c SPDR. The SPI has no transmit buffer, so this is as
+* close to back-to-back as it gets: the USART in SPI master mode (MSPIM),
+* which has one, shares its pins with the @c nCS of the Flash (@c TXD) and
+* the @c RESET of the W5100 (@c XCK). Define this to revert to the plain
+* driver, eg, to compare the two.
+*
+* The saving is in CPU cycles between bytes, which only the target shows. The
+* host simulator models bus time but not instructions (see sim_bus_cycles()), so
+* both drivers report the same figures there; the benefit has not been measured.
+*/
+/* #define SPI_POLLED */
+
 /**
 * @brief A coordinate in device space.
 */
@@ -86,17 +109,30 @@ typedef struct {
 *
 * The time-out is set to 8s.
 *
-* At #WDT_TIMEOUT intervals, the CPU will be woken from power-down mode. The WDT
-* ISR checks whether sampling should be initiated. Once execution returns to the
-* main loop, the CPU goes to power-down, again. The CPU maybe woken at any time
-* by other sources, as well, such as a limit switch and/or an incoming HTTP
-* request. Those requests could delay the CPU for as long they require with no
-* fear of resetting the WDT; since the System Reset Mode is not activated, the
-* WDT Interrupt will simply be queued, if it occurs before any previously
-* activated ISR returns.
+* At #WDT_TIMEOUT intervals, the CPU will be woken from power-down mode. The
+* main loop then checks whether sampling should be initiated (see #EVT_WDT) and
+* the CPU goes to power-down, again. The CPU maybe woken at any time by other
+* sources, as well, such as a limit switch and/or an incoming HTTP request.
+* Those requests could delay the CPU for as long they require with no fear of
+* resetting the WDT; since the System Reset Mode is not activated, the WDT
+* Interrupt will simply be posted as an event for the main loop.
 */
 #define WDT_TIMEOUT     _BV(WDP3) | _BV(WDP0)
 
+/**
+* @brief Seconds between two #WDT_TIMEOUT interrupts; the granularity of any
+* deadline that is only checked upon them (see #WDT_TICKS()).
+*/
+#define WDT_PERIOD      8
+
+/**
+* @brief Converts @p sec seconds to #WDT_TIMEOUT interrupts, rounding up.
+*
+* The first interrupt may come at any time after a deadline has started, so one
+* of @c n interrupts runs out between @c n - 1 and @c n periods later.
+*/
+#define WDT_TICKS(sec)  (((sec) + WDT_PERIOD - 1) / WDT_PERIOD)
+
 /**
 * @brief Default device IP address.
 */
@@ -232,9 +268,20 @@ int8_t sys_set(uint8_t setting, void* value);
 
 /**
 * @brief Frequency of CPU clock, required by <avr/delay.h>.
+*
+* This is the rate the MCU idles, samples and drives the motors at; everything
+* derived from it at compile time (delays, Timer/Counter1) assumes it. See
+* #F_CPU_FAST.
 */
 #define F_CPU (4000000UL)
 
+/**
+* @brief Frequency of CPU clock while serving HTTP requests.
+*
+* That of the crystal, undivided (see clk_fast()).
+*/
+#define F_CPU_FAST (16000000UL)
+
 /**
 * @brief USART baud rate.
 *
@@ -255,6 +302,13 @@ int8_t sys_set(uint8_t setting, void* value);
 */
 #define UBRR_VALUE (int)(F_CPU/16/USART_BAUD - 1)
 
+/**
+* @brief Value for the baud rate register at #F_CPU_FAST.
+*
+* The error at #USART_BAUD is 0.2\%, as well.
+*/
+#define UBRR_VALUE_FAST (int)(F_CPU_FAST/16/USART_BAUD - 1)
+
 /**
 * @brief Value of @c TWPS0 and @c TWPS1 bits of @c TWSR register.
 */
@@ -286,131 +340,146 @@ int8_t sys_set(uint8_t setting, void* value);
 #define TWBR_VALUE (int)((F_CPU/F_TWI-16)/2/TWI_RATE_VAL)
 
 /**
-* @brief Socket of W5100 that corresponds to the HTTP server.
+* @brief Value for the TWI rate register at #F_CPU_FAST.
 */
-#define HTTP_SOCKET     0
+#define TWBR_VALUE_FAST (int)((F_CPU_FAST/F_TWI-16)/2/TWI_RATE_VAL)
 
 /**
-* @brief Port the HTTP server is listening to.
-*/
-#define HTTP_PORT       80
-
-/**
-* @brief Available output buffer size in the network module (chip).
+* @brief Amount of W5100 sockets that serve HTTP.
 *
-* This is just a convenience. The actual setting is done in code (main()).
+* Sockets @c 0 up to @c HTTP_SOCKETS-1 all listen to #HTTP_PORT, so that as
+* many clients may be connected at the same time (see listen_http_socket()).
 */
-#define HTTP_BUF_SIZE   2048
+#define HTTP_SOCKETS    4
+
 /**
-* @brief Size of the buffer used in parsing query parameters.
-*
-* This much space is allocated upon calling srvr_call() and should be large
-* enough to contain all the acceptable parameters (token + value) for any given
-* resource.
-*
-* It is safe to assume that the server will use this amount of memory only once
-* for a single HTTP request.
-*
-* It is possible to run the server without allocating buffer for such a task
-* (simply by setting this to @c 0).
+* @brief Port the HTTP server is listening to.
 */
-#define QUERY_BUF_LEN       105
+#define HTTP_PORT       80
 
 /**
-* @brief The maximum number of acceptable parameters for any one resource.
+* @brief Tx and Rx buffer size of each HTTP socket; one of @c NET_SIZE_*.
 *
-* This should be equal to the maximum number of query string parameters that are
-* expected by any *one* of the available resource handlers.
+* The W5100 has 8KB for each direction to share among its four sockets (see
+* net_socket_init()); 2KB each lets all of them hold a whole response header
+* and a few Flash pages at a time. Update #HTTP_BUF_SIZE to match.
 */
-#define QUERY_PARAM_LEN     6
+#define HTTP_SOCKET_SIZE NET_SIZE_2
 
 /**
-* @brief The amount of total records to store in the EEPROM Log.
+* @brief Available output buffer size of each HTTP socket in the network module
+* (chip).
 *
-* The available host EEPROM is 1KB, whereas each log record requires 11 bytes
-* (see #LogRecord). It is decided to keep tract of the last 90 measurements, so
-* the circular buffer requires a total of 990 bytes. From the remainder bytes,
-* two more are used; one for #log_index and one for #log_count.
+* This is just a convenience. The actual setting is #HTTP_SOCKET_SIZE.
 */
-#define LOG_LEN             90
+#define HTTP_BUF_SIZE   2048
 
 /**
-* @brief The EEPROM address to start storing log records.
+* @brief Maximum amount of requests served over a single (persistent)
+* connection.
 *
-* The circular buffer is stored at the last 990 bytes of the EEPROM. Thus, its
-* lowest byte is at this address.
+* The response to the last one closes the connection (`Connection:close').
 */
-#define LOG_BASE_ADDR       34
+#define HTTP_KEEP_ALIVE_MAX     32
 
 /**
-* @brief Value of @c SPSR. This should only affect bit @c SPI2X.
+* @brief Seconds a connection may remain idle before it is closed.
 *
-* Currently, \f$ clk_{IO} \f$ is 4MHz. The 25LC1024 supports transfer rates up
-* to 20MHz. The closest that can be attained with the current configuration is
-* 2MHz. This requires setting bit @c SPI2X but none of the @c SPR1:0 of @c SPCR.
+* Idleness is only checked whenever the WDT wakes the CPU, every #WDT_PERIOD
+* seconds (see #WDT_TICKS()), so a connection is actually closed after 8 to 16s
+* without any requests.
 */
-#define FLS_SPSR        _BV(SPI2X)
+#define HTTP_KEEP_ALIVE_IDLE    16
 
 /**
-* @brief Value of @c SPCR. This should only affect bits @c SPCR1:0.
+* @brief Seconds a client may take to send the request-line and headers of a
+* request, once it has begun.
+*
+* A request is only parsed once its head has arrived whole (see
+* handle_http_socket()); until then, it waits in the input buffer of the
+* socket. If it is still incomplete after this long, the client is sent a 408
+* (Request Timeout) and the connection is closed (see tick_http_sockets()).
 *
-* Currently, \f$ clk_{IO} \f$ is 4MHz. The 25LC1024 supports transfer rates up
-* to 20MHz. The closest that can be attained with the current configuration is
-* 2MHz. This requires setting bit @c SPI2X but none of the @c SPR1:0 of @c SPCR.
+* That is only checked whenever the WDT wakes the CPU, every #WDT_PERIOD seconds
+* (see #WDT_TICKS()), so the 408 is actually sent 8 to 16s after the request
+* has begun.
 */
-#define FLS_SPCR        0
+#define HTTP_REQUEST_TIMEOUT    16
 
 /**
-* @brief First flash page address of index.
+* @brief Maximum size of a request-line, including its CRLF.
 *
-* The file starts at this page and extends for #FILE_SIZE_INDEX bytes.
-* Currently, allocated 15KiB.
+* A longer one is answered with a 414 (URI Too Long) and the connection is
+* closed.
 */
-#define FILE_PAGE_INDEX         0
+#define HTTP_LINE_MAX           256
 
 /**
-* @brief First flash page address of style.css.
+* @brief Maximum size of the head of a request; its request-line, headers and
+* the empty line that ends them.
 *
-* The file starts at this page and extends for #FILE_SIZE_STYLE_CSS bytes.
-* Currently, allocated 5KiB.
+* A larger one is answered with a 431 (Request Header Fields Too Large) and the
+* connection is closed. It should be less than #HTTP_BUF_SIZE, so that a head
+* that is still incomplete at this size is known to be too large, rather than
+* left waiting for a buffer that cannot take any more.
 */
-#define FILE_PAGE_STYLE_CSS     60
-
+#define HTTP_HEAD_MAX           1024
 /**
-* @brief First flash page address of logo.png.
+* @brief Size of the buffer used in parsing query parameters.
+*
+* This much space is allocated upon calling srvr_call() and should be large
+* enough to contain all the acceptable parameters (token + value) for any given
+* resource.
 *
-* The file starts at this page and extends for #FILE_SIZE_LOGO_PNG bytes.
-* Currently, allocated 5KiB.
+* It is safe to assume that the server will use this amount of memory only once
+* for a single HTTP request.
+*
+* It is possible to run the server without allocating buffer for such a task
+* (simply by setting this to @c 0).
 */
-#define FILE_PAGE_LOGO_PNG      80
+#define QUERY_BUF_LEN       105
 
 /**
-* @brief First flash page address of client.js.
+* @brief The maximum number of acceptable parameters for any one resource.
 *
-* The file starts at this page and extends for #FILE_SIZE_CLIENT_JS bytes.
-* Currently, allocated all the way to the end.
+* This should be equal to the maximum number of query string parameters that are
+* expected by any *one* of the available resource handlers.
 */
-#define FILE_PAGE_CLIENT_JS     100
+#define QUERY_PARAM_LEN     6
 
 /**
-* @brief Size of the index file.
+* @brief Value of @c SPSR. This should only affect bit @c SPI2X.
+*
+* \f$ clk_{IO} \f$ is 4MHz or, while serving HTTP requests, 16MHz. The 25LC1024
+* supports transfer rates up to 20MHz. Setting bit @c SPI2X but none of the
+* @c SPR1:0 of @c SPCR attains 2MHz or 8MHz, respectively.
 */
-#define FILE_SIZE_INDEX         8393
+#define FLS_SPSR        _BV(SPI2X)
 
 /**
-* @brief Size of the style.css file.
+* @brief Value of @c SPCR. This should only affect bits @c SPCR1:0.
+*
+* \f$ clk_{IO} \f$ is 4MHz or, while serving HTTP requests, 16MHz. The 25LC1024
+* supports transfer rates up to 20MHz. Setting bit @c SPI2X but none of the
+* @c SPR1:0 of @c SPCR attains 2MHz or 8MHz, respectively.
 */
-#define FILE_SIZE_STYLE_CSS     1233
+#define FLS_SPCR        0
 
 /**
-* @brief Size of the logo.png file.
+* @brief Maximum amount of assets of the Flash served as resources.
+*
+* Assets are listed in the asset directory of the Flash (see #FLS_TOC_PAGE).
+* Any beyond this amount are not served.
 */
-#define FILE_SIZE_LOGO_PNG      4288
+#define RSRC_FILES_MAX          8
 
 /**
-* @brief Size of the client.js file.
+* @brief Size of the buffer holding the paths of the assets (see
+* #RSRC_FILES_MAX).
+*
+* Assets whose path does not fit in what is left of the buffer are not served.
 */
-#define FILE_SIZE_CLIENT_JS     6670
+#define RSRC_PATHS_LEN          96
 
 /**
 * @brief Pulls Flash @c nCS low.
@@ -838,21 +907,43 @@ int8_t sys_set(uint8_t setting, void* value);
 */
 #define NET_BUF_LEN (100)
 
+/**
+* @brief Number of bytes staged in SRAM before being written to the Tx buffer of
+* the W5100 (see net_send()).
+*
+* Each write costs a 4-byte SPI frame per byte in addition to the handful of
+* frames needed to locate and advance the socket pointers; staging the many
+* short fragments of a response pays the latter once per this many bytes.
+*/
+#define NET_STAGE_LEN (64)
+
+/**
+* @brief Milliseconds net_wait_tx() waits for the peer of a socket to make room
+* in its Tx buffer, before giving up on it.
+*
+* The free size is polled once per millisecond, so that a client that stops
+* reading holds up the main loop (the other sockets, the motors and the request
+* timeouts) for no longer than this; its connection is then dropped. The time is
+* that of #F_CPU_FAST, at which requests are served; it is four times as long,
+* should the motors keep the clock at #F_CPU.
+*/
+#define NET_TX_TIMEOUT (2000)
+
 /**
 * @brief Value of @c SPCR. This should only affect bits @c SPCR1:0.
 *
-* Currently, \f$ clk_{IO} \f$ is 4MHz. The W5100 supports transfer rates up
-* to 14MHz. The closest that can be attained with the current configuration is
-* 2MHz. This requires setting bit @c SPI2X but none of the @c SPR1:0 of @c SPCR.
+* \f$ clk_{IO} \f$ is 4MHz or, while serving HTTP requests, 16MHz. The W5100
+* supports transfer rates up to 14MHz. Setting bit @c SPI2X but none of the
+* @c SPR1:0 of @c SPCR attains 2MHz or 8MHz, respectively.
 */
 #define NET_SPCR        0
 
 /**
 * @brief Value of @c SPCR. This should only affect bits @c SPCR1:0.
 *
-* Currently, \f$ clk_{IO} \f$ is 4MHz. The W5100 supports transfer rates up
-* to 14MHz. The closest that can be attained with the current configuration is
-* 2MHz. This requires setting bit @c SPI2X but none of the @c SPR1:0 of @c SPCR.
+* \f$ clk_{IO} \f$ is 4MHz or, while serving HTTP requests, 16MHz. The W5100
+* supports transfer rates up to 14MHz. Setting bit @c SPI2X but none of the
+* @c SPR1:0 of @c SPCR attains 2MHz or 8MHz, respectively.
 */
 #define NET_SPSR        _BV(SPI2X)
 
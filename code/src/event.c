@@ -0,0 +1,51 @@
+#include "event.h"
+#include "clock.h"
+#include "net.h"
+#include "task.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/**
+* @ingroup event
+* @brief Pending events; a bit per EVT_* value.
+*/
+static volatile uint8_t evt_flags;
+
+void evt_post(uint8_t evt) {
+    uint8_t sreg    =  SREG;
+
+    cli();
+    evt_flags      |=  _BV(evt);
+    SREG            =  sreg;
+}
+
+uint8_t evt_pending() {
+    return evt_flags;
+}
+
+void evt_dispatch() {
+    uint8_t events;
+
+    cli();
+    events      =  evt_flags;
+    evt_flags   =  0;
+    sei();
+
+    /* Motor events come first, so that a sampling in progress is carried on
+    * before any HTTP request gets to reposition the motors. */
+    if(bit_is_set(events, EVT_MOTOR)) task_update();
+
+    /* Requests are served at the full clock rate, unless the motors are
+    * running; the MCU returns to #F_CPU right after, before it may sleep. */
+    if(bit_is_set(events, EVT_NET)) {
+        clk_fast();
+        handle_net_interrupt();
+        clk_slow();
+    }
+
+    if(bit_is_set(events, EVT_WDT)) {
+        tick_http_sockets();
+        task_tick();
+    }
+}
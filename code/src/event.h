@@ -0,0 +1,67 @@
+/**
+* @file
+* @addtogroup event Event
+*
+* @brief Work deferred from the ISRs to the main loop.
+*
+* ISRs do as little as possible: they note what happened with evt_post() and
+* return. The main loop calls evt_dispatch() which, in turn, calls the handler
+* of each posted event with interrupts enabled. This way, serving a lengthy HTTP
+* response never delays the ISRs of the motors or the limit switches. It also
+* means the SPI and TWI buses are only ever driven by the main loop, so an ISR
+* never interrupts a transaction in progress.
+* @{
+*/
+
+#ifndef EVENT_H_INCL
+#define EVENT_H_INCL
+
+#include <inttypes.h>
+
+/**
+* @brief The W5100 has asserted @c INT1.
+*
+* Since @c INT1 is level-triggered, its ISR masks it until the socket interrupts
+* have been handled (see handle_net_interrupt()).
+*/
+#define EVT_NET         0
+
+/**
+* @brief The motors have reported an event (see task_update()).
+*/
+#define EVT_MOTOR       1
+
+/**
+* @brief The Watchdog Timer has timed out (see task_tick() and
+* tick_http_sockets()).
+*/
+#define EVT_WDT         2
+
+/**
+* @brief Posts event @p evt for the main loop to handle.
+*
+* Events are not counted; posting an event that is still pending has no effect.
+* It may be called from an ISR as well as from the main loop.
+*
+* @param[in] evt One of the EVT_* values.
+*/
+void evt_post(uint8_t evt);
+
+/**
+* @brief Returns whether any events are pending.
+*
+* @returns @c 0, if there are none; non-zero, otherwise.
+*/
+uint8_t evt_pending();
+
+/**
+* @brief Calls the handlers of the events posted so far.
+*
+* Events posted by the handlers themselves (or by ISRs meanwhile) are left for
+* the next call.
+*/
+void evt_dispatch();
+
+/** @} */
+
+#endif /* EVENT_H_INCL */
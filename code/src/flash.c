@@ -4,6 +4,7 @@
 #include <avr/io.h>
 
 #include <util/delay.h>
+#include <string.h>
 
 void fls_select() {
     /* Disable SPI, if running. */
@@ -58,13 +59,36 @@ void fls_command(uint8_t c, uint8_t* data) {
 }
 
 void fls_exchange(uint8_t c, uint16_t page, uint8_t* buf, uint16_t len) {
+    fls_exchange_at(c, page, 0, buf, len);
+}
+
+void fls_read(uint16_t page, uint8_t offset, uint8_t* buf, uint16_t len) {
+    fls_exchange_at(FLS_READ, page, offset, buf, len);
+}
+
+void fls_write(uint16_t page, uint8_t offset, uint8_t* buf, uint16_t len) {
+    fls_wait_WIP();
+    fls_command(FLS_WREN, NULL);
+    fls_exchange_at(FLS_WRITE, page, offset, buf, len);
+    fls_wait_WIP();
+}
+
+void fls_erase(uint8_t c, uint16_t page) {
+    fls_wait_WIP();
+    fls_command(FLS_WREN, NULL);
+    fls_exchange_at(c, page, 0, NULL, 0);
+    fls_wait_WIP();
+}
+
+static void fls_exchange_at(uint8_t c, uint16_t page, uint8_t offset,
+                            uint8_t* buf, uint16_t len) {
     uint16_t i;
     uint8_t addr[3];
 
-    /* Calculate the starting address of @p page. */
+    /* Calculate the address of byte @p offset of @p page. */
     addr[0]     =  page >> 8;
     addr[1]     =  page & 0xFF;
-    addr[2]     =  0;
+    addr[2]     =  offset;
 
     /* Send the command. */
     fls_select();
@@ -80,11 +104,51 @@ void fls_exchange(uint8_t c, uint16_t page, uint8_t* buf, uint16_t len) {
     }
 
     /* Send data, if any. */
+#ifdef SPI_POLLED
     for(i = 0 ; i < len; ++i) {
         SPDR    =  buf[i];
         loop_until_bit_is_set(SPSR, SPIF);
 
         buf[i]  =  SPDR;
     }
+#else
+    /* The byte to send next is fetched, and the one received is stored, while
+    * the current one is being shifted; only reloading @c SPDR is left to do
+    * in between. */
+    if(len) {
+        uint8_t next;
+        uint8_t in;
+
+        SPDR    =  buf[0];
+        for(i = 1 ; i < len ; ++i) {
+            next        =  buf[i];
+            loop_until_bit_is_set(SPSR, SPIF);
+
+            in          =  SPDR;
+            SPDR        =  next;
+            buf[i - 1]  =  in;
+        }
+        loop_until_bit_is_set(SPSR, SPIF);
+        buf[len - 1]    =  SPDR;
+    }
+#endif
     fls_deselect();
 }
+
+uint8_t fls_toc_count() {
+    uint8_t head[sizeof(FLS_TOC_MAGIC)];    /* Magic and amount of entries. */
+
+    fls_read(FLS_TOC_PAGE, 0, head, sizeof(head));
+    if(memcmp(head, FLS_TOC_MAGIC, sizeof(head) - 1)) return 0;
+
+    return head[sizeof(head) - 1] < FLS_TOC_LEN ? head[sizeof(head) - 1]
+                                                : FLS_TOC_LEN;
+}
+
+void fls_toc_entry(uint8_t i, FlsEntry* entry) {
+    /* Slot @c 0 is the header. */
+    uint16_t addr   =  (uint16_t)(i + 1) * sizeof(FlsEntry);
+
+    fls_read(FLS_TOC_PAGE + (addr >> 8), addr & 0xFF, (uint8_t*)entry,
+             sizeof(FlsEntry));
+}
@@ -108,6 +108,98 @@
 */
 #define FLS_WPEN    7
 
+/**
+* @brief First page of the asset directory.
+*
+* The directory is a table of contents of the assets (UI files) stored in the
+* Flash. It spans #FLS_TOC_PAGES pages divided into #FlsEntry slots; the first
+* slot is the header (#FLS_TOC_MAGIC followed by the amount of entries) and each
+* of the rest describes an asset. Assets are stored on whole pages after the
+* directory. The image is produced by the @c pack tool of the host build.
+*/
+#define FLS_TOC_PAGE        0
+
+/**
+* @brief Number of pages the asset directory spans.
+*/
+#define FLS_TOC_PAGES       4
+
+/**
+* @brief Maximum amount of entries in the asset directory.
+*/
+#define FLS_TOC_LEN         (FLS_TOC_PAGES * 256 / sizeof(FlsEntry) - 1)
+
+/**
+* @brief The first bytes of a valid asset directory.
+*/
+#define FLS_TOC_MAGIC       "ATOC"
+
+/**
+* @brief Number of pages in a sector; the unit erased by #FLS_SE (32KB).
+*/
+#define FLS_SECTOR_PAGES    128
+
+/**
+* @brief First page of the measurement Log (see log.h).
+*
+* The Log spans #FLS_LOG_SECTORS whole sectors up to the end of the Flash; the
+* asset directory and the assets must lie below this page.
+*/
+#define FLS_LOG_PAGE        128
+
+/**
+* @brief Number of sectors the measurement Log spans.
+*/
+#define FLS_LOG_SECTORS     3
+
+/**
+* @brief Size of FlsEntry#path (including null-byte).
+*/
+#define FLS_PATH_LEN        20
+
+/**
+* @brief Size of FlsEntry#type (including null-byte).
+*/
+#define FLS_TYPE_LEN        32
+
+/**
+* @brief Value of FlsEntry#encoding for assets stored as they are.
+*/
+#define FLS_ENC_IDENTITY    0
+
+/**
+* @brief Value of FlsEntry#encoding for assets stored compressed with gzip.
+*/
+#define FLS_ENC_GZIP        1
+
+/**
+* @brief An entry of the asset directory (see #FLS_TOC_PAGE).
+*
+* Multi-byte members are little-endian. The layout is the same on the host, so
+* that the @c pack tool may use this very structure.
+*/
+typedef struct {
+    /** @brief The absolute path the asset is served at (null-terminated). */
+    uint8_t  path[FLS_PATH_LEN];
+
+    /** @brief Value of the `Content-Type' header (null-terminated). */
+    uint8_t  type[FLS_TYPE_LEN];
+
+    /** @brief Hash of the contents, to be used as an entity tag. */
+    uint32_t etag;
+
+    /** @brief The page the asset starts at. */
+    uint16_t page;
+
+    /** @brief The size of the asset in bytes. */
+    uint16_t size;
+
+    /** @brief Either #FLS_ENC_IDENTITY or #FLS_ENC_GZIP. */
+    uint8_t  encoding;
+
+    uint8_t  reserved[3];
+} FlsEntry;
+
 /**
 * @brief Prepare the SPI bus to communicate with the Flash.
 *
@@ -183,4 +275,67 @@ void fls_command(uint8_t c, uint8_t* data);
 */
 void fls_exchange(uint8_t c, uint16_t page, uint8_t* buf, uint16_t len);
 
+/**
+* @brief Read data from the Flash starting at byte @p offset of @p page.
+*
+* Unlike writing, reading is not confined to a single page; the address wraps
+* around at the end of the memory only (*25LC1024 p.6*). So, @p len may span
+* several pages.
+*
+* @param[in] page The page to start reading from (@c 0 through @c 511).
+* @param[in] offset The byte of @p page to start reading from.
+* @param[out] buf The bytes read.
+* @param[in] len The amount of bytes to read.
+*/
+void fls_read(uint16_t page, uint8_t offset, uint8_t* buf, uint16_t len);
+
+/**
+* @brief Write data to the Flash starting at byte @p offset of @p page.
+*
+* It waits for any previous write cycle to complete, sets the write enable latch
+* and sends the data. It returns once the data have been written. As with
+* fls_exchange(), the data wrap around to the beginning of @p page, so
+* @p offset + @p len should not exceed 256. The contents of @p buf are altered.
+*
+* @param[in] page The page to write to (@c 0 through @c 511).
+* @param[in] offset The byte of @p page to start writing at.
+* @param[in,out] buf The bytes to write.
+* @param[in] len The amount of bytes to write.
+*/
+void fls_write(uint16_t page, uint8_t offset, uint8_t* buf, uint16_t len);
+
+/**
+* @brief Erase the page or sector @p page belongs to.
+*
+* It waits for any previous write cycle to complete, sets the write enable latch
+* and sends command @p c. It returns once the erase cycle has completed.
+*
+* @param[in] c Either #FLS_PE or #FLS_SE.
+* @param[in] page Any page of the page or sector to erase.
+*/
+void fls_erase(uint8_t c, uint16_t page);
+
+/**
+* @brief Exchange data with the Flash starting at byte @p offset of @p page.
+*
+* See fls_exchange(), which is equivalent with @p offset being @c 0.
+*/
+static void fls_exchange_at(uint8_t c, uint16_t page, uint8_t offset,
+                            uint8_t* buf, uint16_t len);
+
+/**
+* @brief Returns the amount of entries in the asset directory.
+*
+* @returns @c 0, if there is no valid directory (see #FLS_TOC_MAGIC).
+*/
+uint8_t fls_toc_count();
+
+/**
+* @brief Reads entry @p i of the asset directory.
+*
+* @param[in] i The entry to read; less than fls_toc_count().
+* @param[out] entry The entry.
+*/
+void fls_toc_entry(uint8_t i, FlsEntry* entry);
+
 #endif /* FLASH_H_INCL */
@@ -3,9 +3,14 @@
 #include "sbuffer.h"
 #include "stream_util.h"
 
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
 #include <stdio.h>
 #include <ctype.h> /* isxdigit(), tolower() */
 
+#include "http_match.inc"
+
 static ServerSettings* srvr;
 
 /**
@@ -26,11 +31,30 @@ static uint16_t chunk_len;
 */
 static uint16_t chunk_pos;
 
+/**
+* @ingroup http_parser
+* @brief Denotes whether the last chunk of a chunked message has been read.
+*/
+static uint8_t is_chunk_end;
+
+/**
+* @ingroup http_parser
+* @brief Amount of bytes of the message-body (see l_next()).
+*/
+static uint16_t body_len;
+
+/**
+* @ingroup http_parser
+* @brief Amount of bytes read from the message-body (see l_next()).
+*/
+static uint16_t body_pos;
+
 void http_parser_set_server(ServerSettings* new_settings) {
     srvr    = new_settings;
 }
 
 void http_parse_request(HTTPRequest* req) {
+    uint16_t start   =  s_tell();   /* Where the request begins. */
     uint8_t c;
     int8_t c_type;
     req->method                  =  SRVR_NOT_SET;
@@ -38,19 +62,35 @@ void http_parse_request(HTTPRequest* req) {
     req->v_major                 =  SRVR_NOT_SET;
     req->v_minor                 =  SRVR_NOT_SET;
     req->accept                  =  SRVR_NOT_SET;
+    req->accept_mask             =  SRVR_NOT_SET;
     req->content_type            =  SRVR_NOT_SET;
-    req->content_length          =  SRVR_NOT_SET;
+    req->content_length          =  0;
     req->transfer_encoding       =  SRVR_NOT_SET;
+    req->connection              =  SRVR_NOT_SET;
+    req->if_none_match           =  SRVR_NOT_SET;
+    req->range                   =  SRVR_NOT_SET;
+    req->if_range                =  SRVR_NOT_SET;
+    req->limit                   =  SRVR_NOT_SET;
 
     /* Parse request- or status-line. */
     c_type = s_next(&c);
     c_type = parse_request_line(req, &c);
 
-    if(req->uri == SRVR_NOT_SET) return;
+    /* The rest of a request whose line is too long is of no interest; it is
+    * neither served nor is its connection kept. */
+    if((uint16_t)(s_tell() - start) > HTTP_LINE_MAX) {
+        req->limit   =  LIMIT_LINE;
+        return;
+    }
+
+    /* Even if the URI is not available, the headers are needed to tell where
+    * the message ends. */
+    if(c_type == EOF) return;
 
     /* Parse headers. */
     c_type = s_next(&c);    /* Discard LF and load next character. */
     c_type = parse_headers(req, &c);
+    if((uint16_t)(s_tell() - start) > HTTP_HEAD_MAX) req->limit = LIMIT_HEAD;
 
     /* After parsing headers, if CRLF was returned, an empty line is implied. */
 
@@ -64,13 +104,26 @@ void http_parse_request(HTTPRequest* req) {
         chunk_len   = 0;
         chunk_pos   = 0;
     }
+    is_chunk_end    = 0;
+    body_len        = req->content_length;
+    body_pos        = 0;
+}
+
+void http_discard_body(HTTPRequest* req) {
+    uint8_t c;
+
+    if(req->transfer_encoding == TRANSFER_COD_CHUNK) {
+        while(!c_next(&c));
+    } else {
+        while(!l_next(&c));
+    }
 }
 
 int8_t parse_request_line(HTTPRequest* req, uint8_t* c) {
     int8_t c_type;
 
     /* Retrieve the method and discard SP. */
-    c_type = stream_match(&srvr->consts[METHOD_MIN], METHOD_MAX, c);
+    c_type = match_token(&srvr->consts[METHOD_MIN], match_method, c);
     if(c_type >= 0) req->method = c_type;
     while(*c == ' ') c_type = s_next(c);
 
@@ -95,7 +148,7 @@ int8_t parse_http_version(HTTPRequest* req, uint8_t* c) {
     int8_t c_type;
     uint8_t digits;
 
-    c_type = stream_match(&srvr->consts[HTTP_SCHEME], HTTP_SCHEME + 1, c);
+    c_type = stream_match(&srvr->consts[HTTP_SCHEME], 1, c);
 
     if(c_type >= 0 && *c == '/') {
 
@@ -123,7 +176,7 @@ int8_t parse_headers(HTTPRequest* req, uint8_t* c) {
 
     while(c_type != EOF && !is_emptyln) {
         /* Attempt to identify a header */
-        c_type = stream_match(&srvr->consts[HEADER_MIN], HEADER_MAX, c);
+        c_type = match_token(&srvr->consts[HEADER_MIN], match_header, c);
 
         /* If there is a potential match terminated by a ":", then that match is
         * valid. (No sort spacing is allowed in the header-name.) */
@@ -136,24 +189,34 @@ int8_t parse_headers(HTTPRequest* req, uint8_t* c) {
             * a CRLF sequence. */
             if(c_type == OTHER) {
                 if(idx == HEADER_ACCEPT) {
-                    c_type = parse_header_accept(&(req->accept), &qvalue, c);
+                    c_type = parse_header_accept(&(req->accept),
+                                                 &(req->accept_mask),
+                                                 &qvalue, c);
+                } else if(idx == HEADER_CONNECTION) {
+                    c_type = parse_header_connection(&(req->connection), c);
                 } else if(idx == HEADER_CONTENT_LENGTH) {
                     c_type = parse_uint16(&(req->content_length), c);
+                } else if(idx == HEADER_IF_NONE_MATCH) {
+                    c_type = parse_header_if_none_match(req, c);
+                } else if(idx == HEADER_IF_RANGE) {
+                    c_type = parse_header_if_range(req, c);
+                } else if(idx == HEADER_RANGE) {
+                    c_type = parse_header_range(req, c);
                 } else if(idx == HEADER_TRANSFER_ENC) {
                     c_type = parse_header_transfer_coding(
                                 &(req->transfer_encoding), c);
                 }
             }
 
-        /* In case of an unsupported header, the line should be discarded. */
+        /* In case of an unsupported header, the line should be discarded; only
+        * a CR may end it. */
         } else {
-            do {
-                if(*c == '\r' && is_CRLF(*c)) {
-                    c_type = CRLF;
-                    s_next(c); /* Load LF into @c c. */
-                    break;
-                }
-            } while((c_type = s_next(c)) != EOF);
+            while(!is_CRLF(*c) && (c_type = s_skip_to('\r', c)) != EOF);
+
+            if(c_type != EOF) {
+                c_type = CRLF;
+                s_next(c); /* Load LF into @c c. */
+            }
         }
 
         /* Check whether the end of headers has been reached. */
@@ -178,14 +241,14 @@ int8_t parse_headers(HTTPRequest* req, uint8_t* c) {
 }
 
 int8_t parse_header_transfer_coding(uint8_t* value, uint8_t* c) {
-    int8_t c_type;
+    int8_t c_type = 0;
 
     /* Combinations of transfer-codings are not supported. If none has been
     * previously specified attempt to identify this one. */
-    if(*value == 0) {
+    if(*value == SRVR_NOT_SET) {
 
-        c_type =
-            stream_match(&srvr->consts[TRANSFER_COD_MIN], TRANSFER_COD_MAX, c);
+        c_type = match_token(&srvr->consts[TRANSFER_COD_MIN],
+                             match_transfer_cod, c);
 
         /* An acceptable transfer-coding has been found; pass it into @p req.
         * As a note, punctuation characters (comma, in particular) is used to
@@ -208,12 +271,189 @@ int8_t parse_header_transfer_coding(uint8_t* value, uint8_t* c) {
     return c_type;
 }
 
-int parse_header_accept(int8_t* media_range, uint16_t* qvalue, uint8_t* c) {
+int8_t parse_header_connection(uint8_t* value, uint8_t* c) {
+    int8_t c_type;  /* The character type that is read last (eg. EOF, CRLF). */
+    int8_t idx;     /* The potentially matched connection option. */
+
+    do {
+        if(*c == ',') {
+            c_type = s_next(c);
+            c_type = discard_LWS(c);
+            if(c_type == CRLF) break;
+        }
+
+        /* Identify the connection option. */
+        idx = match_token(&srvr->consts[CONNECTION_MIN], match_connection, c);
+        c_type = discard_LWS(c);
+
+        /* A match is only valid if terminated by a list delimiter. Once
+        * specified, `close' prevails over any other option. */
+        if(idx >= 0 && (c_type == CRLF || *c == ',')
+        && *value != CONNECTION_CLOSE) {
+            *value  = idx;
+        }
+
+        /* Discard the rest of an unsupported option. */
+        while(c_type != EOF && c_type != CRLF && *c != ',') {
+            c_type = discard_param(c);
+            if(*c == ';') s_next(c);
+        }
+
+    } while(*c == ',');
+
+    return c_type;
+}
+
+int8_t parse_header_if_none_match(HTTPRequest* req, uint8_t* c) {
+    int8_t c_type;  /* The character type that is read last (eg. EOF, CRLF). */
+    uint32_t etag;  /* The entity tag currently read. */
+
+    do {
+        if(*c == ',') {
+            c_type = s_next(c);
+            c_type = discard_LWS(c);
+            if(c_type == CRLF) break;
+        }
+
+        /* `*' matches any entity tag, so it prevails over any other value. */
+        if(*c == '*') {
+            req->if_none_match  =  ETAG_ANY;
+            c_type = s_next(c);
+
+        } else {
+            c_type = parse_etag(&etag, c);
+
+            if(!c_type && req->if_none_match == SRVR_NOT_SET
+            && etag == req->etag) {
+                req->if_none_match  =  ETAG_SOME;
+            }
+        }
+        if(c_type != EOF) c_type = discard_LWS(c);
+
+        /* Discard the rest of an unsupported entity tag. */
+        while(c_type != EOF && c_type != CRLF && *c != ',') {
+            c_type = discard_param(c);
+            if(*c == ';') s_next(c);
+        }
+
+    } while(*c == ',');
+
+    return c_type;
+}
+
+int8_t parse_header_if_range(HTTPRequest* req, uint8_t* c) {
+    int8_t c_type;
+
+    /* A strong entity tag is required; a weak one or a date never match. */
+    req->if_range   =  ETAG_NONE;
+    if(*c == '"') {
+        c_type = parse_etag(&req->if_range_etag, c);
+        if(!c_type) {
+            c_type = discard_LWS(c);
+            if(c_type == CRLF) req->if_range = ETAG_SOME;
+        }
+    } else {
+        c_type = OTHER;
+    }
+
+    return c_type;
+}
+
+int8_t parse_header_range(HTTPRequest* req, uint8_t* c) {
+    int8_t c_type;
+    int8_t unit;        /* The range unit. */
+    uint16_t first;     /* The first position of the range. */
+    uint16_t last;      /* The last position of the range. */
+
+    unit = match_token(&srvr->consts[RANGE_UNIT_MIN], match_range_unit, c);
+    if(unit < 0 || *c != '=') return OTHER;
+
+    c_type = s_next(c);
+    if(!c_type) c_type = parse_range_pos(&first, c);
+    if(c_type || *c != '-') return c_type ? c_type : OTHER;
+
+    c_type = s_next(c);
+    if(!c_type) c_type = parse_range_pos(&last, c);
+    if(c_type) return c_type;
+
+    /* Only a single range is supported, so anything other than the end of the
+    * header invalidates it. */
+    c_type = discard_LWS(c);
+    if(c_type == CRLF
+    && (first != RANGE_OPEN || last != RANGE_OPEN)
+    && (first == RANGE_OPEN || last == RANGE_OPEN || first <= last)) {
+        req->range          =  unit;
+        req->range_first    =  first;
+        req->range_last     =  last;
+    }
+
+    return c_type;
+}
+
+int8_t parse_range_pos(uint16_t* value, uint8_t* c) {
+    int8_t c_type   =  0;
+    uint32_t pos    =  0;
+    uint8_t digits  =  0;
+
+    while(!c_type && isdigit(*c)) {
+        pos     =  pos * 10 + *c - '0';
+        if(pos >= RANGE_OPEN) return OTHER;
+
+        ++digits;
+        c_type = s_next(c);
+    }
+    *value  =  digits ? pos : RANGE_OPEN;
+
+    return c_type;
+}
+
+int8_t parse_etag(uint32_t* etag, uint8_t* c) {
+    int8_t c_type   =  0;
+    uint8_t digits  =  0;   /* Hex-digits read; more than 8 if invalid. */
+
+    /* Weak and strong tags compare the same (weak comparison). */
+    if(*c == 'W') {
+        if(s_next(c)) return EOF;
+        if(*c != '/') return OTHER;
+        if(s_next(c)) return EOF;
+    }
+    if(*c != '"') return OTHER;
+
+    /* An opaque-tag may not contain double quotes, so there is no need to
+    * handle quoted-pairs. Also, it is compared case-sensitively and the tags of
+    * the server are in lower-case. */
+    *etag   =  0;
+    while(!(c_type = s_next(c)) && *c != '"' && *c != '\r') {
+        if((isdigit(*c) || (*c >= 'a' && *c <= 'f')) && digits < 8) {
+            *etag <<=  4;
+            *etag  +=  *c <= '9' ? *c - '0' : *c - 'a' + 10;
+            ++digits;
+        } else {
+            digits  =  9;
+        }
+    }
+    if(c_type) return c_type;
+    if(*c != '"') return OTHER;
+
+    /* Step past the closing double quote, even if the tag is not valid, so
+    * that it is not taken for the start of a quoted-string. */
+    if(s_next(c)) return EOF;
+
+    return digits == 8 ? 0 : OTHER;
+}
+
+int parse_header_accept(int8_t* media_range,
+                        uint8_t* mask,
+                        uint16_t* qvalue,
+                        uint8_t* c) {
     int8_t c_type;  /* The character type that is read last (eg. EOF, CRLF). */
     int8_t idx;     /* The potentially matched media range. */
 
     uint16_t qvalue_new = 0;
 
+    /* The first `Accept' narrows the media ranges down from all of them. */
+    if(*media_range == (int8_t)SRVR_NOT_SET) *mask = 0;
+
     do {
         qvalue_new = 1000;  /* Reset q-value to 'preferred'. */
 
@@ -224,7 +464,7 @@ int parse_header_accept(int8_t* media_range, uint16_t* qvalue, uint8_t* c) {
         }
 
         /* Identify the first media range. */
-        idx = stream_match(&srvr->consts[MIME_MIN], MIME_MAX, c);
+        idx = match_token(&srvr->consts[MIME_MIN], match_mime, c);
         c_type = discard_LWS(c);
 
         /* In case that a potential match was terminated by a valid delimiter,
@@ -236,6 +476,7 @@ int parse_header_accept(int8_t* media_range, uint16_t* qvalue, uint8_t* c) {
             if(c_type == CRLF || *c == ',') {
                 *qvalue         = 1000;
                 *media_range    = idx;
+                *mask          |= _BV(idx);
 
             } else if(*c == ';') {
 
@@ -244,6 +485,10 @@ int parse_header_accept(int8_t* media_range, uint16_t* qvalue, uint8_t* c) {
                     c_type = parse_header_param_qvalue(&qvalue_new, c);
                 } while(*c == ';');
 
+                /* A q-value of 0 rules the media range out. */
+                if(qvalue_new)  *mask  |=  _BV(idx);
+                else            *mask  &= ~_BV(idx);
+
                 /* Update media range if it has a higher q-value than the
                 * previous. */
                 if(qvalue_new > *qvalue) {
@@ -274,6 +519,50 @@ int parse_header_accept(int8_t* media_range, uint16_t* qvalue, uint8_t* c) {
     return c_type;
 }
 
+/**
+* @ingroup http_parser
+* @brief Returns the class of character @p c in the tables of match_token();
+* @c 0, if it occurs in no token.
+*/
+static inline uint8_t match_class_of(uint8_t c) {
+    return c >= ' ' && c <= '~' ? pgm_read_byte(&match_class[c - ' ']) : 0;
+}
+
+static int8_t match_token(uint8_t** desc, const uint8_t* table, uint8_t* c) {
+    const uint8_t* row  =  table;   /* The current state. */
+    uint8_t        idx  =  0;       /* Characters matched so far. */
+    uint8_t        cls;
+    uint8_t        next;
+
+    /* Follow the table while more than one token remains possible. */
+    for(;;) {
+        cls     =  match_class_of(*c);
+        next    =  cls ? pgm_read_byte(&row[cls]) : 0;
+
+        /* No token continues with @p c; it delimits the one that ends here,
+        * if any. */
+        if(!next) {
+            next    =  pgm_read_byte(&row[0]);
+            return next ? next - 1 : OTHER;
+        }
+
+        ++idx;
+        if(s_next(c)) return EOF;
+        if(next & 0x80) break;
+        row     =  &table[next * MATCH_WIDTH];
+    }
+
+    /* Compare the rest of the only token left. */
+    next   &=  0x7F;
+    while(desc[next][idx]
+          && match_class_of(*c) == match_class_of(desc[next][idx])) {
+        ++idx;
+        if(s_next(c)) return EOF;
+    }
+
+    return desc[next][idx] ? OTHER : next;
+}
+
 static int8_t parse_uri(HTTPRequest* req, uint8_t* c) {
     uint8_t min     = 0;
     uint8_t max     = srvr->rsrc_len;
@@ -350,6 +639,12 @@ static int8_t parse_uri(HTTPRequest* req, uint8_t* c) {
         }
     }
 
+    /* Discard whatever is left of the URI (such as an unavailable path or a
+    * query string that does not apply), so that the HTTP version follows. */
+    while(c_type != EOF && *c != ' ' && !is_c_CRLF(*c)) {
+        c_type = s_next(c);
+    }
+
     /* Discard while space. */
     while(c_type != EOF && *c == ' ') {
         c_type = s_next(c);
@@ -429,7 +724,7 @@ static int8_t parse_host(uint8_t* c) {
     uint8_t* ptr[1];
 
     /* Match scheme "HTTP://" */
-    c_type = stream_match(&srvr->consts[HTTP_SCHEME_S], HTTP_SCHEME_S + 1, c);
+    c_type = stream_match(&srvr->consts[HTTP_SCHEME_S], 1, c);
 
     /* If scheme is acceptable, parse the host name. */
     if(c_type >= 0) {
@@ -526,6 +821,9 @@ int8_t q_value(uint16_t* value, uint8_t* c) {
 }
 
 int8_t c_next(uint8_t* c) {
+    /* Whatever follows the last chunk belongs to the next message. */
+    if(is_chunk_end) return EOF;
+
     if(chunk_pos == chunk_len) {
         update_chunk(c);
     }
@@ -534,20 +832,30 @@ int8_t c_next(uint8_t* c) {
         ++chunk_pos;
         return s_next(c);
     }
-    is_chunk_on = 0;
-    chunk_len   = 0;
-    chunk_pos   = 0;
+    is_chunk_on  = 0;
+    chunk_len    = 0;
+    chunk_pos    = 0;
+    is_chunk_end = 1;
     return EOF;
 }
 
+int8_t l_next(uint8_t* c) {
+    if(body_pos == body_len) return EOF;
+
+    ++body_pos;
+    return s_next(c);
+}
+
 static int8_t update_chunk(uint8_t* c) {
     int8_t c_type = 0;
 
     if(!is_chunk_on) {
         is_chunk_on = 1;
 
-        /* Discard */
-        while(!isxdigit(*c) && c_type != EOF) c_type = s_next(c);
+        /* Read the first hex-digit of the size, discarding anything before. */
+        do {
+            c_type = s_next(c);
+        } while(!isxdigit(*c) && c_type != EOF);
 
     } else {
         /* Discard CRLF to advance to the size of the next chunk. Folding has no
@@ -561,7 +869,13 @@ static int8_t update_chunk(uint8_t* c) {
 
     chunk_pos   = 0;
     chunk_len   = 0;
-    c_type      = parse_hex16(&chunk_len, c);
+
+    /* Not parse_hex16(), as its source is this very chunked stream. */
+    while(c_type != EOF && isxdigit(*c)) {
+        chunk_len  *= 16;
+        chunk_len  += *c <= '9' ? *c - '0' : tolower(*c) - 'a' + 10;
+        c_type = s_next(c);
+    }
 
     /* Discard the rest of the line. */
     while(c_type != EOF && !is_c_CRLF(*c)) c_type = s_next(c);
@@ -572,9 +886,16 @@ static int8_t update_chunk(uint8_t* c) {
     /* If the last chunk was read, discard trailer headers (if any) up to, and
     * including, the final empty line. */
     if(chunk_len == 0) {
-        /* @c c would either be a CR (of the terminating CRLF sequence) or the
-        * start of a new header. */
-        c_type = discard_to_line(c);
+        uint8_t peek;
+
+        /* Either the terminating CRLF sequence follows or a trailer header. */
+        if(!s_peek(&peek, 0) && peek == '\r'
+        && !s_peek(&peek, 1) && peek == '\n') {
+            s_drop(2);
+            c_type = CRLF;
+        } else {
+            c_type = discard_to_line(c);
+        }
     }
 
     return c_type;
@@ -619,7 +940,7 @@ static int8_t discard_to_line(uint8_t* c) {
 
     while(!is_emptyln && c_type != EOF) {
         /* Discard bytes until a CRLF. */
-        while((c_type = s_next(c)) != EOF && !is_CRLF(*c));
+        while((c_type = s_skip_to('\r', c)) != EOF && !is_CRLF(*c));
 
         /* Should a CRLF be followed by another CRLF, then an empty line has
         * been reached. */
@@ -49,18 +49,34 @@ void http_parser_set_server(ServerSettings* srvr);
 *
 * In case #HTTPRequest.transfer_encoding is set to #TRANSFER_COD_CHUNK, use of
 * #c_next() gives direct (transparent) access to the entity-body and should be
-* preferred over #s_next().
+* preferred over #s_next(). Otherwise, #l_next() reads no further than
+* #HTTPRequest.content_length bytes. Either way, the message ends where they
+* return EOF (see http_discard_body()).
 *
-* Parsing of the incoming message stops, if the supplied URI has not been
-* specified in #server_consts.
+* The headers are parsed even if the supplied URI has not been specified in
+* #server_consts, so that the end of the message may be found.
+*
+* A request-line longer than #HTTP_LINE_MAX ends parsing there; a head larger
+* than #HTTP_HEAD_MAX is parsed all the same. Either is noted in @c .limit and
+* the stream is left at an unknown position.
 *
 * @param[in,out] req An #HTTPRequest representation of the HTTP request found on
 *   the input stream. All @c .query members should be set to appropriate values
 *   by the time, or when, rsrc_inform() is invoked. The other members will be
-*   internally initialised to #SRVR_NOT_SET.
+*   internally initialised to #SRVR_NOT_SET (@c .content_length to @c 0).
 */
 void http_parse_request(HTTPRequest* req);
 
+/**
+* @brief Discards whatever is left of the message-body of @p req.
+*
+* Once done, the next byte on the stream is the first of the next request, if
+* one has already arrived (pipelining).
+*
+* @param[in] req The request as parsed by http_parse_request().
+*/
+void http_discard_body(HTTPRequest* req);
+
 /**
 * @brief Extract method, request URI and HTTP version of the request line from
 * the stream.
@@ -134,6 +150,115 @@ static int8_t parse_http_version(HTTPRequest* req, uint8_t* c);
 */
 static int8_t parse_headers(HTTPRequest* req, uint8_t* c);
 
+/**
+* @brief Read the connection options of the `Connection' header from stream.
+*
+* Only `close' and `keep-alive' are recognised; any other option (such as
+* `Upgrade') is ignored. Should `close' be specified, it is preserved even if
+* `keep-alive' is specified as well, or later on.
+*
+* As the `Connection' header is a list, it may appear more than once in a
+* request. The @p value returned by a previous call to this function can be used
+* in its new invocation.
+*
+* @param[in,out] value #CONNECTION_CLOSE, #CONNECTION_KEEP_ALIVE or, if neither
+*   has been specified, left intact. Initially, it should contain a known
+*   invalid value.
+* @param[in,out] c The first character to start parsing from and the last one
+*   read from the stream.
+* @returns One of:
+*   - #CRLF
+*   - EOF
+*/
+static int8_t parse_header_connection(uint8_t* value, uint8_t* c);
+
+/**
+* @brief Read the entity tags of the `If-None-Match' header from stream.
+*
+* Only entity tags generated by this server (eight hex-digits; see
+* #TXFx_FW_ETAG) are recognised, either weak or strong, as well as `*'. Each of
+* the former is compared against HTTPRequest#etag, as it is read; `*' prevails
+* over any of them.
+*
+* @param[in,out] req HTTPRequest variable to be updated with the values found
+*   on stream; @link HTTPRequest::if_none_match if_none_match@endlink.
+* @param[in,out] c The first character to start parsing from and the last one
+*   read from the stream.
+* @returns One of:
+*   - #CRLF
+*   - EOF
+*/
+static int8_t parse_header_if_none_match(HTTPRequest* req, uint8_t* c);
+
+/**
+* @brief Read the validator of the `If-Range' header from stream.
+*
+* Only a strong entity tag may satisfy `If-Range' (see parse_etag()); anything
+* else (a weak entity tag or a date) is recorded as #ETAG_NONE.
+*
+* @param[in,out] req HTTPRequest variable to be updated with the values found
+*   on stream; @link HTTPRequest::if_range if_range@endlink and
+*   @link HTTPRequest::if_range_etag if_range_etag@endlink.
+* @param[in,out] c The first character to start parsing from and the last one
+*   read from the stream.
+* @returns One of:
+*   - #CRLF
+*   - #OTHER
+*   - EOF
+*/
+static int8_t parse_header_if_range(HTTPRequest* req, uint8_t* c);
+
+/**
+* @brief Read the range of the `Range' header from stream.
+*
+* A single range in any of the range units of #server_consts is recognised, in
+* either of the forms @c first-last, @c first- or @c -suffix. Anything else
+* leaves @link HTTPRequest::range range@endlink unset, so that the whole
+* representation is sent.
+*
+* @param[in,out] req HTTPRequest variable to be updated with the values found
+*   on stream; @link HTTPRequest::range range@endlink,
+*   @link HTTPRequest::range_first range_first@endlink and
+*   @link HTTPRequest::range_last range_last@endlink.
+* @param[in,out] c The first character to start parsing from and the last one
+*   read from the stream.
+* @returns One of:
+*   - #CRLF
+*   - #OTHER
+*   - EOF
+*/
+static int8_t parse_header_range(HTTPRequest* req, uint8_t* c);
+
+/**
+* @brief Read a position of a range from stream.
+*
+* @param[out] value The position read or #RANGE_OPEN, if there are no digits on
+*   stream.
+* @param[in,out] c The first character to start parsing from and the last one
+*   read from the stream.
+* @returns One of:
+*   - @c 0
+*   - #OTHER; if the position is too large.
+*   - EOF
+*/
+static int8_t parse_range_pos(uint16_t* value, uint8_t* c);
+
+/**
+* @brief Read an entity tag from stream.
+*
+* An entity tag is an opaque quoted string, optionally preceded by @c W/ (weak
+* validator). Only those of eight hex-digits are recognised.
+*
+* @param[out] etag The value of the entity tag.
+* @param[in,out] c The first character to start parsing from and the last one
+*   read from the stream. On success, the one following the closing quote.
+* @returns One of:
+*   - @c 0; if an entity tag was read into @p etag.
+*   - #OTHER; if there is no valid entity tag on stream.
+*   - EOF
+*/
+static int8_t parse_etag(uint32_t* etag, uint8_t* c);
+
 /**
 * @brief Parse Accept header body-value is search of media ranges.
 *
@@ -157,9 +282,15 @@ static int8_t parse_headers(HTTPRequest* req, uint8_t* c);
 * Initially, a non-acceptable index of #server_consts and 0, respectively,
 * should suffice.
 *
+* Every supported media range with a non-zero q-value is also flagged in
+* @p mask (see HTTPRequest#accept_mask), which the first header (that is, while
+* @p media_range is #SRVR_NOT_SET) clears.
+*
 * @param[in,out] media_range Index of #server_consts that corresponds to
 *   the highest, so far, qvalue-ranking media range. Upon first invocation, it
 *   should contain a known invalid value.
+* @param[in,out] mask Bit-mask of the acceptable media ranges, bit @c n
+*   standing for the one at #MIME_MIN + @c n.
 * @param[in,out] qvalue The q-value of the @p media_range. On the first
 *   invocation, it should contain a value of 0.
 * @param[out] c The last character read from the stream.
@@ -168,9 +299,32 @@ static int8_t parse_headers(HTTPRequest* req, uint8_t* c);
 *   - EOF
 */
 static int parse_header_accept(int8_t* media_range,
+                               uint8_t* mask,
                                uint16_t* qvalue,
                                uint8_t* c);
 
+/**
+* @brief Identify a token of a fixed group (such as a method or header name) on
+* the stream.
+*
+* It serves the same purpose as stream_match(), with the same outcome, but in a
+* single pass: the generated @p table (see http_match.inc) gives, for each
+* character read, the state the comparison moves on to, rather than narrowing
+* the candidates down one by one. Once only a single token remains possible, the
+* rest of it is compared directly against @p desc. Letters match in either case.
+*
+* @param[in] desc The tokens of the group, in the order of @p table.
+* @param[in] table The transition table of the group (in program memory).
+* @param[in,out] c The first character to compare and the last one read from
+*   the stream.
+* @returns One of:
+*   - Index of @p desc with a possible match; whether it is valid depends on
+*       the delimiter left in @p c.
+*   - #OTHER; on certainty of no match.
+*   - EOF; if end of stream has been reached before hitting a match/mismatch.
+*/
+static int8_t match_token(uint8_t** desc, const uint8_t* table, uint8_t* c);
+
 /**
 * @brief Match input from stream against the available server endpoints.
 *
@@ -275,13 +429,27 @@ int8_t q_value(uint16_t* value, uint8_t* c);
 * In case the bytes of a particular chunk have been depleted, the first byte of
 * the next chunk (if one exists) is returned. This function should only be
 * called if a `Tranfser-Encoding' header with a value of `@c chunked' has been
-* specified.
+* specified. Once the last chunk has been read, it keeps returning @c EOF until
+* the next request is parsed.
 *
 * @param[out] c The character read from the stream.
 * @returns @c 0 on a successful read; @c EOF, otherwise.
 */
 int8_t c_next(uint8_t* c);
 
+/**
+* @brief Read the next byte of a message-body of known length into @p c.
+*
+* The length is that of the `Content-Length' header
+* (#HTTPRequest.content_length) or @c 0, if there is none. This function should
+* be used in place of s_next() for messages that are not chunked, so that
+* reading the body does not run into the next request.
+*
+* @param[out] c The character read from the stream.
+* @returns @c 0 on a successful read; @c EOF, past the end of the body.
+*/
+int8_t l_next(uint8_t* c);
+
 /**
 * @brief Parse the size of the next chunk.
 *
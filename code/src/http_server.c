@@ -11,16 +11,42 @@
 
 #include <string.h>
 
+/* Text shared by the fragments and the blocks below, so that it is only
+* written down once. */
+#define TXS_ln              "\r\n"
+#define TXS_STATUS_200      "200 OK"
+#define TXS_STATUS_202      "202 Accepted"
+#define TXS_STATUS_206      "206 Partial Content"
+#define TXS_STATUS_400      "400 Bad Request"
+#define TXS_STATUS_404      "404 Not Found"
+#define TXS_STATUS_405      "405 Method Not Allowed"
+#define TXS_STATUS_406      "406 Not Acceptable"
+#define TXS_STATUS_408      "408 Request Timeout"
+#define TXS_STATUS_414      "414 URI Too Long"
+#define TXS_STATUS_431      "431 Request Header Fields Too Large"
+#define TXS_STATUS_501      "501 Not Implemented"
+#define TXS_STATUS_503      "503 Service Unavailable"
+#define TXS_SERVER          "Server:uServer (TEIA)"
+#define TXS_JSON_LINE       "Content-Type:application/json;charset=utf-8"
+#define TXS_BINARY_LINE     "Content-Type:application/octet-stream"
+#define TXS_CSV_LINE        "Content-Type:text/csv;header=present"
+#define TXS_CACHE_NO        "Cache-Control:no-cache"
+#define TXS_LENGTH_ZERO     "Content-Length:0"
+
+/* The status line (past the version) of a block and the headers every response
+* carries, but `Connection'. */
+#define TXS_HEAD(status)    status TXS_ln TXS_SERVER TXS_ln
+
 uint8_t txf_space[] PROGMEM         = " ";
 uint8_t txf_colon[] PROGMEM         = ":";
-uint8_t txf_CRLF[] PROGMEM          = "\r\n";
-uint8_t txf_status_200[] PROGMEM    = "200 OK";
-uint8_t txf_status_202[] PROGMEM    = "202 Accepted";
-uint8_t txf_status_400[] PROGMEM    = "400 Bad Request";
-uint8_t txf_status_404[] PROGMEM    = "404 Not Found";
-uint8_t txf_status_405[] PROGMEM    = "405 Method Not Allowed";
-uint8_t txf_status_501[] PROGMEM    = "501 Not Implemented";
-uint8_t txf_status_503[] PROGMEM    = "503 Service Unavailable";
+uint8_t txf_CRLF[] PROGMEM          = TXS_ln;
+uint8_t txf_status_200[] PROGMEM    = TXS_STATUS_200;
+uint8_t txf_status_202[] PROGMEM    = TXS_STATUS_202;
+uint8_t txf_status_400[] PROGMEM    = TXS_STATUS_400;
+uint8_t txf_status_404[] PROGMEM    = TXS_STATUS_404;
+uint8_t txf_status_405[] PROGMEM    = TXS_STATUS_405;
+uint8_t txf_status_501[] PROGMEM    = TXS_STATUS_501;
+uint8_t txf_status_503[] PROGMEM    = TXS_STATUS_503;
 uint8_t txf_HTTPv[] PROGMEM         = "HTTP/1.1";
 uint8_t txf_allow[] PROGMEM         = "Allow";
 uint8_t txf_connection_close[] PROGMEM
@@ -29,18 +55,26 @@ uint8_t txf_content_length[] PROGMEM
                                     = "Content-Length";
 uint8_t txf_content_type[] PROGMEM  = "Content-Type";
 uint8_t txf_retry_after[] PROGMEM   = "Retry-After";
-uint8_t txf_server[] PROGMEM        = "Server:uServer (TEIA)";
+uint8_t txf_server[] PROGMEM        = TXS_SERVER;
 uint8_t txf_comma[] PROGMEM         = ",";
 uint8_t txf_semicolon[] PROGMEM     = ";";
 uint8_t txf_chunked[] PROGMEM       = "Transfer-Encoding:chunked";
 uint8_t txf_char_utf8[] PROGMEM     = "charset=utf-8";
-uint8_t txf_JSON_line[] PROGMEM
-        = "Content-Type:application/json;charset=utf-8";
+uint8_t txf_JSON_line[] PROGMEM     = TXS_JSON_LINE;
 uint8_t txf_gzip_line[] PROGMEM     = "Content-Encoding:gzip";
 uint8_t txf_JS_line[] PROGMEM       = "text/javascript;charset=utf-8";
 uint8_t txf_css_line[] PROGMEM      = "text/css";
-uint8_t txf_cache_no[] PROGMEM      = "Cache-Control:no-cache";
+uint8_t txf_cache_no[] PROGMEM      = TXS_CACHE_NO;
 uint8_t txf_cache_public[] PROGMEM  = "Cache-Control:public";
+uint8_t txf_keep_alive[] PROGMEM    = "Connection:keep-alive";
+uint8_t txf_status_304[] PROGMEM    = "304 Not Modified";
+uint8_t txf_etag[] PROGMEM          = "ETag";
+uint8_t txf_status_206[] PROGMEM    = TXS_STATUS_206;
+uint8_t txf_status_416[] PROGMEM    = "416 Range Not Satisfiable";
+uint8_t txf_content_range[] PROGMEM = "Content-Range";
+uint8_t txf_accept_ranges[] PROGMEM = "Accept-Ranges";
+uint8_t txf_vary_accept[] PROGMEM   = "Vary:Accept";
+uint8_t txf_status_406[] PROGMEM    = TXS_STATUS_406;
 
 
 /* Doxygen does not handle attributes (like PROGMEM) very well. */
@@ -78,7 +112,116 @@ PGM_P srvr_txf[] PROGMEM = {
     txf_JS_line,
     txf_css_line,
     txf_cache_no,
-    txf_cache_public
+    txf_cache_public,
+    txf_keep_alive,
+    txf_status_304,
+    txf_etag,
+    txf_status_206,
+    txf_status_416,
+    txf_content_range,
+    txf_accept_ranges,
+    txf_vary_accept,
+    txf_status_406
+};
+
+uint8_t txb_200_json[] PROGMEM      = TXS_HEAD(TXS_STATUS_200)
+                                      TXS_JSON_LINE     TXS_ln
+                                      TXS_CACHE_NO      TXS_ln;
+uint8_t txb_206_json[] PROGMEM      = TXS_HEAD(TXS_STATUS_206)
+                                      TXS_JSON_LINE     TXS_ln
+                                      TXS_CACHE_NO      TXS_ln;
+uint8_t txb_400_json[] PROGMEM      = TXS_HEAD(TXS_STATUS_400)
+                                      TXS_JSON_LINE     TXS_ln
+                                      TXS_CACHE_NO      TXS_ln;
+uint8_t txb_400[] PROGMEM           = TXS_HEAD(TXS_STATUS_400)
+                                      TXS_CACHE_NO      TXS_ln
+                                      TXS_LENGTH_ZERO   TXS_ln;
+uint8_t txb_404[] PROGMEM           = TXS_HEAD(TXS_STATUS_404)
+                                      TXS_LENGTH_ZERO   TXS_ln;
+uint8_t txb_405[] PROGMEM           = TXS_HEAD(TXS_STATUS_405)
+                                      TXS_LENGTH_ZERO   TXS_ln
+                                      "Allow:";
+uint8_t txb_501[] PROGMEM           = TXS_HEAD(TXS_STATUS_501)
+                                      TXS_LENGTH_ZERO   TXS_ln;
+uint8_t txb_202_retry[] PROGMEM     = TXS_HEAD(TXS_STATUS_202)
+                                      TXS_CACHE_NO      TXS_ln
+                                      TXS_LENGTH_ZERO   TXS_ln
+                                      "Retry-After:";
+uint8_t txb_503_retry[] PROGMEM     = TXS_HEAD(TXS_STATUS_503)
+                                      TXS_CACHE_NO      TXS_ln
+                                      TXS_LENGTH_ZERO   TXS_ln
+                                      "Retry-After:";
+uint8_t txb_408[] PROGMEM           = TXS_HEAD(TXS_STATUS_408)
+                                      TXS_LENGTH_ZERO   TXS_ln;
+uint8_t txb_414[] PROGMEM           = TXS_HEAD(TXS_STATUS_414)
+                                      TXS_LENGTH_ZERO   TXS_ln;
+uint8_t txb_431[] PROGMEM           = TXS_HEAD(TXS_STATUS_431)
+                                      TXS_LENGTH_ZERO   TXS_ln;
+uint8_t txb_200_binary[] PROGMEM    = TXS_HEAD(TXS_STATUS_200)
+                                      TXS_BINARY_LINE   TXS_ln
+                                      TXS_CACHE_NO      TXS_ln;
+uint8_t txb_206_binary[] PROGMEM    = TXS_HEAD(TXS_STATUS_206)
+                                      TXS_BINARY_LINE   TXS_ln
+                                      TXS_CACHE_NO      TXS_ln;
+uint8_t txb_200_csv[] PROGMEM       = TXS_HEAD(TXS_STATUS_200)
+                                      TXS_CSV_LINE      TXS_ln
+                                      TXS_CACHE_NO      TXS_ln;
+uint8_t txb_206_csv[] PROGMEM       = TXS_HEAD(TXS_STATUS_206)
+                                      TXS_CSV_LINE      TXS_ln
+                                      TXS_CACHE_NO      TXS_ln;
+uint8_t txb_406[] PROGMEM           = TXS_HEAD(TXS_STATUS_406)
+                                      "Vary:Accept"     TXS_ln
+                                      TXS_LENGTH_ZERO   TXS_ln;
+
+/*
+* @ingroup http_server
+* @brief Header blocks stored in program space (Flash memory).
+*
+* Each is the whole preamble of a common response, composed at compile-time
+* from the same text as the fragments above (see #TXB_MIN).
+*/
+PGM_P srvr_txb[] PROGMEM = {
+    txb_200_json,
+    txb_206_json,
+    txb_400_json,
+    txb_400,
+    txb_404,
+    txb_405,
+    txb_501,
+    txb_202_retry,
+    txb_503_retry,
+    txb_408,
+    txb_414,
+    txb_431,
+    txb_200_binary,
+    txb_206_binary,
+    txb_200_csv,
+    txb_206_csv,
+    txb_406
+};
+
+/*
+* @ingroup http_server
+* @brief Length of each of #srvr_txb, as known at compile-time.
+*/
+uint8_t srvr_txb_len[] PROGMEM = {
+    sizeof(txb_200_json)    - 1,
+    sizeof(txb_206_json)    - 1,
+    sizeof(txb_400_json)    - 1,
+    sizeof(txb_400)         - 1,
+    sizeof(txb_404)         - 1,
+    sizeof(txb_405)         - 1,
+    sizeof(txb_501)         - 1,
+    sizeof(txb_202_retry)   - 1,
+    sizeof(txb_503_retry)   - 1,
+    sizeof(txb_408)         - 1,
+    sizeof(txb_414)         - 1,
+    sizeof(txb_431)         - 1,
+    sizeof(txb_200_binary)  - 1,
+    sizeof(txb_206_binary)  - 1,
+    sizeof(txb_200_csv)     - 1,
+    sizeof(txb_206_csv)     - 1,
+    sizeof(txb_406)         - 1
 };
 
 /**
@@ -99,6 +242,9 @@ PGM_P srvr_txf[] PROGMEM = {
 *   - Media ranges start at #MIME_MIN, containing #MIME_MAX tokens.
 *   - Transfer codings start at #TRANSFER_COD_MIN, containing #TRANSFER_COD_MAX
 *       tokens.
+*   - Connection options start at #CONNECTION_MIN, containing #CONNECTION_MAX
+*       tokens.
+*   - Range units start at #RANGE_UNIT_MIN, containing #RANGE_UNIT_MAX tokens.
 *
 * For individual elements, refer to macros starting with the group in question
 * (for instance, for methods, check macros starting with "METHOD_").
@@ -106,42 +252,29 @@ PGM_P srvr_txf[] PROGMEM = {
 * There are also some additional tokens, "http" and "http://" represented by
 * #HTTP_SCHEME and #HTTP_SCHEME_S.
 *
-* Should the need to provide additional tokens arise, all that is required is
-* to place those strings in their respective group, making certain to preserve
-* the order and update the corresponding "_MAX" macro to reflect the new number
-* of tokens within each affected group. Note, that any new token should be given
-* in the same letter case as the rest of the tokens.
+* The groups are listed in http_tokens.inc, which also explains how to add a
+* token. The parser identifies them with the tables generated from that list
+* (see http_match.inc) rather than with stream_match().
 */
 static uint8_t* server_consts[] = {
-    /* METHODS, min: 0 max: 8 */
-    "connect",
-    "delete",
-    "get",
-    "head",
-    "options",
-    "post",
-    "put",
-    "trace",
-    /* HEADERS, min: METHODS, max: 4 */
-    "accept",
-    "content-length",
-    "content-type",
-    "transfer-encoding",
-    /* MEDIA RANGES, min: METHODS+HEADERS, max: 6 */
-    "*/*",
-    "application/*",
-    "application/json",
-    "text/*",
-    "text/html",
-    "text/json",
-    /* TRANFSER_CODING, min: METHODS+HEADERS+MEDIA_RANGES, max: 2 */
-    "chunked",
-    "identity",
-    /* HTTP TOKENS, indices: METHODS+HEADERS+MEDIA_RANGES+T_CODING, +1 */
+    #define HTTP_GROUP(name)
+    #define HTTP_TOKEN(token)   token,
+    #include "http_tokens.inc"
+    #undef HTTP_GROUP
+    #undef HTTP_TOKEN
+
+    /* HTTP TOKENS, indices: RANGE_UNIT_MIN+RANGE_UNIT_MAX, +1 */
     "http",
     "http://"
 };
 
+/**
+* @ingroup http_server
+* @brief Non-zero if the connection of the current request is to persist after
+* its response; see srvr_call() and #TXFx_CONNECTION.
+*/
+static uint8_t srvr_keep;
+
 static ServerSettings srvr = {
     .consts         =  server_consts,
 
@@ -161,7 +294,7 @@ void srvr_init() {
     * this should be done every time before calling a resource handler. But, in
     * the current implementation, only JSON formatted data are supported. */
     rsrc_set_parser(&json_parse);
-    rsrc_set_serial(&json_serialise);
+    rsrc_set_serial(&json_serialise, &json_serial_len);
 }
 
 void srvr_set_resources(uint8_t** tokens,
@@ -198,11 +331,55 @@ int16_t srvr_prep_chunk_head(uint16_t num) {
         --i;
     }
 
-    return net_send(HTTP_SOCKET, size, 6, 0);
+    return net_send(get_socket_buf(), size, 6, 0) < 6 ? -1 : 0;
+}
+
+int8_t srvr_get_range(HTTPRequest* req, uint8_t unit, uint32_t* etag,
+                      uint16_t len, uint16_t* first, uint16_t* last) {
+
+    if(req->range != unit) return SRVR_RANGE_NONE;
+
+    /* If the representation has changed, the whole of it is to be sent. */
+    if(req->if_range != SRVR_NOT_SET
+    && (!etag || req->if_range != ETAG_SOME || req->if_range_etag != *etag)) {
+        return SRVR_RANGE_NONE;
+    }
+
+    /* A suffix spans the last @c range_last positions. */
+    if(req->range_first == RANGE_OPEN) {
+        if(!req->range_last || !len) return SRVR_RANGE_BAD;
+
+        *first  =  req->range_last < len ? len - req->range_last : 0;
+        *last   =  len - 1;
+
+    } else {
+        if(req->range_first >= len) return SRVR_RANGE_BAD;
+
+        *first  =  req->range_first;
+        *last   =  req->range_last < len ? req->range_last : len - 1;
+    }
+
+    return SRVR_RANGE_OK;
+}
+
+int16_t srvr_prep_content_range(uint8_t unit, uint16_t first, uint16_t last,
+                                uint16_t len) {
+
+    srvr_prep(TXF_CONTENT_RANGE, TXF_HS,
+              TXFx_FROMRAM, RANGE_UNIT_MIN + unit, TXF_SP);
+
+    if(first == RANGE_OPEN) {
+        srvr_prep(TXFx_FW_STRING, "*");
+    } else {
+        srvr_prep(TXFx_FW_UINT, first, TXFx_FW_STRING, "-",
+                  TXFx_FW_UINT, last);
+    }
+
+    return srvr_prep(TXFx_FW_STRING, "/", TXFx_FW_UINT, len, TXF_ln);
 }
 
 int16_t srvr_compile(uint8_t flush, ...) {
-    int16_t outcome = 0;        /* As returned from net_send(). */
+    int16_t outcome = 0;        /* @c -1, once net_send() accepts too little. */
     uint8_t buf[TXF_BUF_LEN];   /* Stores a fragment until it is sent. */
     uint8_t* str;               /* Pointer to the string to actually send. */
     unsigned int txf_id;        /* Value of any optional argument; txf index. */
@@ -223,6 +400,11 @@ int16_t srvr_compile(uint8_t flush, ...) {
             txf_id      =  va_arg(ap, unsigned int);
         }
 
+        /* The `Connection' header depends on the current request. */
+        if(txf_id == TXFx_CONNECTION) {
+            txf_id      =  srvr_keep ? TXF_KEEP_ALIVE : TXF_CONNECTION_CLOSE;
+        }
+
         /* If the fragment resides in program memory, fetch it from there. */
         if(txf_id < TXF_MAX) {
             strcpy_P(buf, (PGM_P)pgm_read_word(&srvr_txf[txf_id]));
@@ -240,22 +422,59 @@ int16_t srvr_compile(uint8_t flush, ...) {
         * sure to set @c str to its first digit. */
         } else if(txf_id == TXFx_FW_UINT) {
             uint8_t len;        /* The number of bytes written. */
-            len =  uint_to_str(&buf[TXF_BUF_LEN - 1], va_arg(ap, uint16_t));
+
+            /* Promoted to (at least) @c unsigned @c int when passed. */
+            len =  uint_to_str(&buf[TXF_BUF_LEN - 1],
+                               (uint16_t)va_arg(ap, unsigned int));
             str = &buf[TXF_BUF_LEN - 1 - len];
 
+        /* An entity tag is printed as eight hex-digits within double quotes. */
+        } else if(txf_id == TXFx_FW_ETAG) {
+            uint32_t etag   =  va_arg(ap, uint32_t);
+            int8_t   i;
+
+            buf[0]  =  '"';
+            for(i = 8 ; i > 0 ; --i) {
+                buf[i]  =  "0123456789abcdef"[etag & 0x0F];
+                etag  >>=  4;
+            }
+            buf[9]  =  '"';
+            buf[10] =  '\0';
+
+        /* A header block is streamed straight from program memory, in as
+        * few pieces as @c buf allows; its length is known beforehand. */
+        } else if(txf_id >= TXB_MIN && txf_id < TXB_MIN + TXB_MAX) {
+            uint8_t i       =  txf_id - TXB_MIN;
+            PGM_P   block   =  (PGM_P)pgm_read_word(&srvr_txb[i]);
+            uint8_t left    =  pgm_read_byte(&srvr_txb_len[i]);
+            uint8_t size;
+
+            while(left && outcome >= 0) {
+                size    =  left < TXF_BUF_LEN ? left : TXF_BUF_LEN;
+                memcpy_P(buf, block, size);
+                if(net_send(get_socket_buf(), buf, size, 0) < size) {
+                    outcome =  -1;
+                }
+                block  +=  size;
+                left   -=  size;
+            }
+            do_send =  0;
+
         /* Ignore any invalid fragment IDs. */
         } else {
             do_send = 0;
         }
 
         if(do_send) {
+            uint16_t len;
 
             if(do_allcap) {
                 strupr(buf);
                 do_allcap   =  0;
             }
 
-            outcome = net_send(HTTP_SOCKET, str, strlen(str), 0);
+            len     =  strlen(str);
+            if(net_send(get_socket_buf(), str, len, 0) < len) outcome = -1;
         }
 
         txf_id = (unsigned int)va_arg(ap, unsigned int);
@@ -264,13 +483,13 @@ int16_t srvr_compile(uint8_t flush, ...) {
     /* Flush all buffered data, if so specified. This should be avoided in case
     * any of the mentioned text fragments could not be written, because, then,
     * the text would not be complete / correct. */
-    if(flush && outcome >= 0) outcome = net_send(0, buf, 0, 1);
+    if(flush && outcome >= 0) net_send(get_socket_buf(), buf, 0, 1);
 
     va_end(ap);
     return outcome;
 }
 
-void srvr_call() {
+uint8_t srvr_call(uint8_t keep) {
     uint8_t uri;            /* ID or requested URI. */
     uint8_t methods;        /* Available methods for requested URI. */
     HTTPRequest req;        /* Request representation. */
@@ -283,6 +502,21 @@ void srvr_call() {
     http_parse_request(&req);
     uri     =  req.uri;
 
+    /* Persistent connections are the default as of HTTP/1.1; earlier versions
+    * have to ask for them. A request line that could not be parsed leaves the
+    * stream in an unknown state, so its connection is never kept; neither is
+    * one whose message-body is in a transfer-coding that is not understood, as
+    * its end cannot be found, or whose head is too large to have been read
+    * whole. */
+    if(req.v_major == SRVR_NOT_SET || req.connection == CONNECTION_CLOSE
+    || req.transfer_encoding == TRANSFER_COD_OTHER
+    || req.limit != SRVR_NOT_SET) {
+        keep    =  0;
+    } else if(req.v_major == 1 && req.v_minor == 0) {
+        keep    =  keep && req.connection == CONNECTION_KEEP_ALIVE;
+    }
+    srvr_keep   =  keep;
+
     /* Initialise the response line with the HTTP version followed by a single
     * space. This should be followed by an appropriate status code, headers and
     * a message body as determined further below. */
@@ -294,37 +528,36 @@ void srvr_call() {
     * its parser is set only once, during initialisation. See srvr_init() and
     * its line with rsrc_set_parser(). */
 
+    /* The message-body ends after its last chunk or `Content-Length' bytes. */
+    if(req.transfer_encoding == TRANSFER_COD_CHUNK) {
+        stream_set_source(&c_next);
+        json_set_source(&c_next);
+    } else {
+        stream_set_source(&l_next);
+        json_set_source(&l_next);
+    }
+
+    /* A request-line or head larger than allowed; return 414 (URI Too Long)
+    * or 431 (Request Header Fields Too Large), respectively. */
+    if(req.limit == LIMIT_LINE) {
+        srvr_send(TXB_414, TXF_CONNECTION_ln, TXF_ln);
+
+    } else if(req.limit == LIMIT_HEAD) {
+        srvr_send(TXB_431, TXF_CONNECTION_ln, TXF_ln);
+
     /* If the URI is not available or if no handler is specified, return 404
     * (Not Found). */
-    if(uri == SRVR_NOT_SET || !srvr.rsrc_handlers[uri].call) {
-        srvr_send(TXF_STATUS_404, TXF_ln,
-                  TXF_STANDARD_HEADERS_ln,
-                  TXF_CONTENT_LENGTH_ZERO_ln, TXF_ln);
-        return;
-    }
+    } else if(uri == SRVR_NOT_SET || !srvr.rsrc_handlers[uri].call) {
+        srvr_send(TXB_404, TXF_CONNECTION_ln, TXF_ln);
 
     /* Method not recognised by the server or entity-body in a transfer-coding
     * it does not understand. Return 501 (Not Implemented). */
-    if(req.method == SRVR_NOT_SET
-    || req.transfer_encoding == TRANSFER_COD_OTHER) {
-        srvr_send(TXF_STATUS_501, TXF_ln,
-                  TXF_STANDARD_HEADERS_ln,
-                  TXF_CONTENT_LENGTH_ZERO_ln, TXF_lnln);
-        return;
-    }
+    } else if(req.method == SRVR_NOT_SET
+           || req.transfer_encoding == TRANSFER_COD_OTHER) {
+        srvr_send(TXB_501, TXF_CONNECTION_ln, TXF_ln);
 
     /* Call the handler, if the requested method has a bit-flag set. */
-    methods = srvr.rsrc_handlers[uri].methods;
-    if(TO_METHOD_FLAG(req.method) & methods) {
-
-        /* Set-up reading a chunked message, if that was specified in the
-        * header. */
-        if(req.transfer_encoding == TRANSFER_COD_CHUNK) {
-            stream_set_source(&c_next);
-            json_set_source(&c_next);
-        }
-
-        /* Call the appropriate handler. */
+    } else if(TO_METHOD_FLAG(req.method) & srvr.rsrc_handlers[uri].methods) {
         (*(srvr.rsrc_handlers[uri].call))(&req);
 
     /* Otherwise, return a 405 (Method Not Allowed), along with an `Allow'
@@ -332,11 +565,10 @@ void srvr_call() {
     } else {
         uint8_t i;
 
-        /* Send the initial headers. */
-        srvr_prep(TXF_STATUS_405, TXF_ln,
-                  TXF_STANDARD_HEADERS_ln,
-                  TXF_CONTENT_LENGTH_ZERO_ln,
-                  TXF_ALLOW, TXF_HS);
+        methods = srvr.rsrc_handlers[uri].methods;
+
+        /* Send the initial headers, up to the value of `Allow'. */
+        srvr_prep(TXB_405);
 
         /* Loop and print all the available methods (in upper-case). */
         for(i = 0 ; i < METHOD_MAX ; ++i) {
@@ -353,8 +585,24 @@ void srvr_call() {
                 methods >>= 1;
             }
         }
-        srvr_send(TXF_lnln);
-
-        return;
+        srvr_send(TXF_ln, TXF_CONNECTION_ln, TXF_ln);
     }
+
+    /* A response that could not be sent whole ends the connection. */
+    if(net_is_lost(get_socket_buf())) srvr_keep = 0;
+
+    /* Whatever the handler has left of the message-body precedes the next
+    * request, if any. */
+    if(srvr_keep) http_discard_body(&req);
+
+    return srvr_keep;
+}
+
+void srvr_reject(uint8_t block) {
+    srvr_keep   =  0;
+    srvr_send(TXF_HTTPv, TXF_SPACE, block, TXF_CONNECTION_ln, TXF_ln);
+}
+
+void srvr_abort() {
+    srvr_keep   =  0;
 }
@@ -123,6 +123,13 @@ typedef struct HTTPRequest {
     /** @brief Value representing the accept media range of the request. */
     int8_t accept;
 
+    /**
+    * @brief Media ranges of `Accept' that are supported and have a non-zero
+    * q-value; bit @c n is set for the one at #MIME_MIN + @c n. All of them
+    * (#SRVR_NOT_SET), if there is no such header.
+    */
+    uint8_t accept_mask;
+
     /** @brief Value representing the transfer encoding of the message. */
     uint8_t transfer_encoding;
 
@@ -132,6 +139,64 @@ typedef struct HTTPRequest {
     /** @brief The length (in octets) of the message. */
     uint16_t content_length;
 
+    /**
+    * @brief Value representing the connection option of the message; either
+    * #CONNECTION_CLOSE or #CONNECTION_KEEP_ALIVE.
+    */
+    uint8_t connection;
+
+    /**
+    * @brief Whether the request is conditional on an `If-None-Match' header;
+    * #ETAG_SOME, if one of its entity tags is @c etag, #ETAG_ANY or
+    * #SRVR_NOT_SET, if there is none or none matches.
+    */
+    uint8_t if_none_match;
+
+    /**
+    * @brief The entity tag of the targeted asset, which those of
+    * `If-None-Match' are compared against; set by rsrc_inform().
+    */
+    uint32_t etag;
+
+    /**
+    * @brief The range unit of a `Range' header (#RANGE_UNIT_BYTES or
+    * #RANGE_UNIT_RECORDS) or #SRVR_NOT_SET, if there is none.
+    *
+    * Only a single range is supported; a header listing more is ignored.
+    */
+    uint8_t range;
+
+    /**
+    * @brief The first position of the range; #RANGE_OPEN, if the range is a
+    * suffix of the representation (see @link HTTPRequest::range_last
+    * range_last@endlink).
+    */
+    uint16_t range_first;
+
+    /**
+    * @brief The last position of the range (inclusive); #RANGE_OPEN, if it
+    * extends to the end of the representation. For a suffix, it is its length.
+    */
+    uint16_t range_last;
+
+    /**
+    * @brief Whether @link HTTPRequest::range range@endlink is conditional on an
+    * `If-Range' header; #ETAG_SOME, #ETAG_NONE or #SRVR_NOT_SET, if there is
+    * none.
+    */
+    uint8_t if_range;
+
+    /**
+    * @brief The entity tag of `If-Range', if it is #ETAG_SOME.
+    */
+    uint32_t if_range_etag;
+
+    /**
+    * @brief The size limit the head of the request exceeds; #LIMIT_LINE,
+    * #LIMIT_HEAD or #SRVR_NOT_SET, if it is within both.
+    */
+    uint8_t limit;
+
     /**
     * @brief Permissible query parameter tokens.
     *
@@ -144,11 +209,53 @@ typedef struct HTTPRequest {
     QueryString         query;
 } HTTPRequest;
 
+/**
+* @brief An entity tag has been specified (see HTTPRequest#etag).
+*/
+#define ETAG_SOME            0
+
+/**
+* @brief Any entity tag (`*') has been specified.
+*/
+#define ETAG_ANY             1
+
+/**
+* @brief A validator that matches no entity tag (such as a date or a weak tag
+* in `If-Range') has been specified.
+*/
+#define ETAG_NONE            2
+
+/**
+* @brief The request-line exceeds #HTTP_LINE_MAX (see HTTPRequest#limit).
+*/
+#define LIMIT_LINE           0
+
+/**
+* @brief The head of the request exceeds #HTTP_HEAD_MAX.
+*/
+#define LIMIT_HEAD           1
+
+/**
+* @brief No range applies; the whole representation is to be sent.
+*/
+#define SRVR_RANGE_NONE      0
+
+/**
+* @brief The range is satisfiable; a 206 (Partial Content) is to be sent.
+*/
+#define SRVR_RANGE_OK        1
+
+/**
+* @brief The range is not satisfiable; a 416 (Range Not Satisfiable) is to be
+* sent.
+*/
+#define SRVR_RANGE_BAD      -1
+
 /**
 * @brief The total amount of text fragments that may be used with
 * srvr_compile().
 */
-#define TXF_MAX              27
+#define TXF_MAX              36
 #define TXF_SPACE             0 /**< @brief A single space. */
 #define TXF_COLON             1 /**< @brief A single colon. */
 #define TXF_CRLF              2 /**< @brief A CRLF sequence (0x0D, 0x0A). */
@@ -176,6 +283,57 @@ typedef struct HTTPRequest {
 #define TXF_CSS_LINE         24 /**< @brief A complete CSS type header line. */
 #define TXF_CACHE_NO_CACHE   25 /**< @brief The text: Cache-Control:no-cache */
 #define TXF_CACHE_PUBLIC     26 /**< @brief The text: Cache-Control:public */
+#define TXF_KEEP_ALIVE       27 /**< @brief The text: Connection:keep-alive */
+#define TXF_STATUS_304       28 /**< @brief The text: 304 Not Modified */
+#define TXF_ETAG             29 /**< @brief The text: ETag */
+#define TXF_STATUS_206       30 /**< @brief The text: 206 Partial Content */
+/** @brief The text: 416 Range Not Satisfiable */
+#define TXF_STATUS_416       31
+#define TXF_CONTENT_RANGE    32 /**< @brief The text: Content-Range */
+#define TXF_ACCEPT_RANGES    33 /**< @brief The text: Accept-Ranges */
+#define TXF_VARY_ACCEPT      34 /**< @brief The text: Vary:Accept */
+#define TXF_STATUS_406       35 /**< @brief The text: 406 Not Acceptable */
+
+/**
+* @brief The first of the header blocks that may be used with srvr_compile().
+*
+* A block is the whole preamble of a common response, past the HTTP version:
+* the status line, the `Server' header and whichever headers are listed below,
+* in this order. It leaves out `Connection' (see #TXF_CONNECTION_ln), which
+* depends on the request, and, unless it is known, `Content-Length'. Blocks are
+* composed at compile-time from the same text as the fragments and are streamed
+* from program memory without being scanned for their length.
+*/
+#define TXB_MIN             128
+
+/**
+* @brief The total amount of header blocks.
+*/
+#define TXB_MAX              17
+#define TXB_200_JSON        (TXB_MIN + 0) /**< @brief 200; JSON; no-cache */
+#define TXB_206_JSON        (TXB_MIN + 1) /**< @brief 206; JSON; no-cache */
+#define TXB_400_JSON        (TXB_MIN + 2) /**< @brief 400; JSON; no-cache */
+/** @brief 400; no-cache; Content-Length:0 */
+#define TXB_400             (TXB_MIN + 3)
+#define TXB_404             (TXB_MIN + 4) /**< @brief 404; Content-Length:0 */
+/** @brief 405; Content-Length:0; `Allow:' (to be followed by its value) */
+#define TXB_405             (TXB_MIN + 5)
+#define TXB_501             (TXB_MIN + 6) /**< @brief 501; Content-Length:0 */
+/** @brief 202; no-cache; Content-Length:0; `Retry-After:' (ditto) */
+#define TXB_202_RETRY       (TXB_MIN + 7)
+/** @brief 503; no-cache; Content-Length:0; `Retry-After:' (ditto) */
+#define TXB_503_RETRY       (TXB_MIN + 8)
+#define TXB_408             (TXB_MIN + 9) /**< @brief 408; Content-Length:0 */
+#define TXB_414             (TXB_MIN + 10) /**< @brief 414; Content-Length:0 */
+#define TXB_431             (TXB_MIN + 11) /**< @brief 431; Content-Length:0 */
+/** @brief 200; `application/octet-stream'; no-cache */
+#define TXB_200_BINARY      (TXB_MIN + 12)
+/** @brief 206; `application/octet-stream'; no-cache */
+#define TXB_206_BINARY      (TXB_MIN + 13)
+#define TXB_200_CSV         (TXB_MIN + 14) /**< @brief 200; CSV; no-cache */
+#define TXB_206_CSV         (TXB_MIN + 15) /**< @brief 206; CSV; no-cache */
+/** @brief 406; `Vary:Accept'; Content-Length:0 */
+#define TXB_406             (TXB_MIN + 16)
 
 /**
 * @brief Alias of #TXF_SPACE.
@@ -208,7 +366,12 @@ TXF_CONTENT_LENGTH, TXF_HS, TXFx_FW_UINT, 0, TXF_ln
 */
 #define TXF_STANDARD_HEADERS_ln \
 TXF_SERVER, TXF_CRLF,           \
-TXF_CONNECTION_CLOSE, TXF_CRLF
+TXFx_CONNECTION, TXF_CRLF
+
+/**
+* @brief The `Connection' header; the one line a header block leaves out.
+*/
+#define TXF_CONNECTION_ln       TXFx_CONNECTION, TXF_CRLF
 
 /**
 * @brief Equivalent to #srvr_compile(1, ..., #SRVR_NOT_SET).
@@ -261,6 +424,23 @@ srvr_compile(0, __VA_ARGS__, SRVR_NOT_SET)
 */
 #define TXFx_FROMRAM        251
 
+/**
+* @brief Print the `Connection' header of the current response in
+* srvr_compile().
+*
+* Expands to #TXF_KEEP_ALIVE, if the connection is to persist after the
+* response, or #TXF_CONNECTION_CLOSE, otherwise (see srvr_call()).
+*/
+#define TXFx_CONNECTION     250
+
+/**
+* @brief Pass an entity tag into srvr_compile().
+*
+* Causes the next argument (a @c uint32_t) to be printed as an entity tag; eight
+* hexadecimal digits within double quotes.
+*/
+#define TXFx_FW_ETAG        249
+
 /**
 * @brief General-context macro for any parameter not set to a known value.
 */
@@ -288,13 +468,17 @@ srvr_compile(0, __VA_ARGS__, SRVR_NOT_SET)
 */
 #define HEADER_MIN           (METHOD_MAX)
 #define HEADER_ACCEPT         0 /**< @brief Header @c Accept. */
-#define HEADER_CONTENT_LENGTH 1 /**< @brief Header @c Content-Length. */
-#define HEADER_CONTENT_TYPE   2 /**< @brief Header @c Content-Type. */
-#define HEADER_TRANSFER_ENC   3 /**< @brief Header @c Transfer-Encoding. */
+#define HEADER_CONNECTION     1 /**< @brief Header @c Connection. */
+#define HEADER_CONTENT_LENGTH 2 /**< @brief Header @c Content-Length. */
+#define HEADER_CONTENT_TYPE   3 /**< @brief Header @c Content-Type. */
+#define HEADER_IF_NONE_MATCH  4 /**< @brief Header @c If-None-Match. */
+#define HEADER_IF_RANGE       5 /**< @brief Header @c If-Range. */
+#define HEADER_RANGE          6 /**< @brief Header @c Range. */
+#define HEADER_TRANSFER_ENC   7 /**< @brief Header @c Transfer-Encoding. */
 /**
 * @brief The number of HTTP header tokens.
 */
-#define HEADER_MAX            4
+#define HEADER_MAX            8
 
 /**
 * @brief The starting index in #server_consts of supported media range literals.
@@ -303,13 +487,16 @@ srvr_compile(0, __VA_ARGS__, SRVR_NOT_SET)
 #define MIME_ANY              0 /**< @brief Media range "* / *". */
 #define MIME_APP_ANY          1 /**< @brief Media range "application/any". */
 #define MIME_APP_JSON         2 /**< @brief Media range "application/json". */
-#define MIME_TEXT_ANY         3 /**< @brief Media range "text/ *". */
-#define MIME_TEXT_HTML        4 /**< @brief Media range "text/html". */
-#define MIME_TEXT_JSON        5 /**< @brief Media range "text/json". */
+/** @brief Media range "application/octet-stream". */
+#define MIME_APP_OCTET        3
+#define MIME_TEXT_ANY         4 /**< @brief Media range "text/ *". */
+#define MIME_TEXT_CSV         5 /**< @brief Media range "text/csv". */
+#define MIME_TEXT_HTML        6 /**< @brief Media range "text/html". */
+#define MIME_TEXT_JSON        7 /**< @brief Media range "text/json". */
 /**
 * @brief The number of media range literals.
 */
-#define MIME_MAX              6
+#define MIME_MAX              8
 
 /**
 * @brief The starting index in #server_consts of available transfer-codings.
@@ -329,8 +516,37 @@ srvr_compile(0, __VA_ARGS__, SRVR_NOT_SET)
 */
 #define TRANSFER_COD_OTHER    TRANSFER_COD_MAX
 
+/**
+* @brief The starting index in #server_consts of supported connection options.
+*/
+#define CONNECTION_MIN      (METHOD_MAX+HEADER_MAX+MIME_MAX+TRANSFER_COD_MAX)
+#define CONNECTION_CLOSE      0 /**< @brief Connection option @c close. */
+#define CONNECTION_KEEP_ALIVE 1 /**< @brief Connection option @c keep-alive. */
+/**
+* @brief The number of connection option literals.
+*/
+#define CONNECTION_MAX       2
+
+/**
+* @brief The starting index in #server_consts of supported range units.
+*/
+#define RANGE_UNIT_MIN      (CONNECTION_MIN+CONNECTION_MAX)
+#define RANGE_UNIT_BYTES      0 /**< @brief Range unit @c bytes. */
+#define RANGE_UNIT_RECORDS    1 /**< @brief Range unit @c records (Log). */
+/**
+* @brief The number of range unit literals.
+*/
+#define RANGE_UNIT_MAX       2
+
+/**
+* @brief An omitted position of a range (see HTTPRequest#range_first).
+*
+* This is not a #server_consts index.
+*/
+#define RANGE_OPEN           (0xFFFF)
+
 /** @brief HTTP literal. */
-#define HTTP_SCHEME          (METHOD_MAX+HEADER_MAX+MIME_MAX+TRANSFER_COD_MAX)
+#define HTTP_SCHEME          (RANGE_UNIT_MIN+RANGE_UNIT_MAX)
 
 /** @brief HTTP scheme with separator. */
 #define HTTP_SCHEME_S        (HTTP_SCHEME + 1)
@@ -456,11 +672,43 @@ void srvr_set_host_name_ip(uint8_t* ip);
 *
 * @param[in] len The size of the chunk. This will be converted into hexadecimal
 *   notation.
-* @returns The outcome of send() (for details, see the return value of
-*   srvr_compile()).
+* @returns As srvr_compile().
 */
 int16_t srvr_prep_chunk_head(uint16_t num);
 
+/**
+* @brief Resolves the range of the request against a representation.
+*
+* The range applies only if it is in @p unit and, should the request carry an
+* `If-Range' header, @p etag is strongly equal to its entity tag. Then, it is
+* resolved into the positions of the representation it actually spans.
+*
+* @param[in] req The request.
+* @param[in] unit The range unit the representation is available in; one of
+*   the RANGE_UNIT_* macros.
+* @param[in] etag The entity tag of the representation or @c NULL, if it has
+*   none (in which case, `If-Range' never matches).
+* @param[in] len The length of the representation in @p unit.
+* @param[out] first The first position the range spans.
+* @param[out] last The last position the range spans (inclusive).
+* @returns One of #SRVR_RANGE_NONE, #SRVR_RANGE_OK or #SRVR_RANGE_BAD.
+*/
+int8_t srvr_get_range(HTTPRequest* req, uint8_t unit, uint32_t* etag,
+                      uint16_t len, uint16_t* first, uint16_t* last);
+
+/**
+* @brief Prepares the `Content-Range' header, followed by a @c CRLF sequence.
+*
+* @param[in] unit One of the RANGE_UNIT_* macros.
+* @param[in] first The first position of the range or #RANGE_OPEN, if the range
+*   was not satisfiable.
+* @param[in] last The last position of the range (inclusive).
+* @param[in] len The length of the representation in @p unit.
+* @returns The outcome of srvr_compile().
+*/
+int16_t srvr_prep_content_range(uint8_t unit, uint16_t first, uint16_t last,
+                                uint16_t len);
+
 /**
 * @brief Compiles a response based on the specified text fragments.
 *
@@ -494,14 +742,12 @@ int16_t srvr_prep_chunk_head(uint16_t num);
 * @param[in] ... Any series of TXF_* macros that specify which text fragments
 *   and in what order should be sent to the network module. The last argument
 *   *should always* be #SRVR_NOT_SET.
-* @returns The outcome of send(): a non-negative number is the amount of
-*   available bytes in the networks module's output buffer after appending the
-*   specified fragments; a negative number indicates that appending the
-*   specified fragments has stopped because one of them could not fit in the
-*   network module's currently available buffer space due to lack of as many
-*   bytes as the returned value.
+* @returns @c 0, if all the specified fragments have been accepted by the
+*   network module; @c -1, if one of them has not (see net_send()), in which
+*   case the rest are not written and nothing is flushed. The connection is lost
+*   by then, so the response should be abandoned.
 */
-int srvr_compile(uint8_t flush, ...);
+int16_t srvr_compile(uint8_t flush, ...);
 
 /**
 * @brief Notify data have arrived on the HTTP server's socket.
@@ -510,8 +756,43 @@ int srvr_compile(uint8_t flush, ...);
 * parsing the incoming data as an HTTP request and returning an appropriate
 * response to the requester entity, either via the use of a user-defined handler
 * (see, #ResourceHandler) or one of predefined messages in case of an exception.
+*
+* The connection persists after the response (HTTP/1.1 default), unless the
+* requester asks for it to be closed (`Connection: close' or HTTP/1.0 without
+* `Connection: keep-alive') or the caller does not allow it to. Either way, the
+* `Connection' header of the response (#TXFx_CONNECTION) says so. If it
+* persists, the request is consumed up to the end of its message-body, so that
+* any request that follows on the stream (pipelining) may be served by calling
+* this function again. It never persists if the response could not be sent whole
+* (see net_is_lost()) or was abandoned by the handler (see srvr_abort()).
+*
+* @param[in] keep Non-zero if the connection may persist after this request.
+* @returns Non-zero if the connection is to persist; @c 0 if it is to be closed
+*   once the response has been sent.
+*/
+uint8_t srvr_call(uint8_t keep);
+
+/**
+* @brief Answers the request on the current socket (see get_socket_buf()) with
+* the header block @p block alone and has the connection closed.
+*
+* This is for requests that are refused before (or instead of) being parsed,
+* such as one that has not arrived in time (#TXB_408). The caller is to close
+* the connection once the response has been sent.
+*
+* @param[in] block One of the TXB_* values of a response without a body.
+*/
+void srvr_reject(uint8_t block);
+
+/**
+* @brief Has the connection of the current request closed once whatever has been
+* sent so far is, without completing the response.
+*
+* This is for handlers that cannot deliver what they have already announced
+* (e.g. a chunk size), so that the requester sees a truncated response rather
+* than a well-formed one with missing data.
 */
-void srvr_call();
+void srvr_abort();
 
 #endif /* HTTP_SERVER_H_INCL */
 /** @} */
@@ -1,6 +1,7 @@
 
 #include "json_parser.h"
 #include "w5100.h"
+#include "sbuffer.h"
 #include "util.h"
 #include "defs.h"
 
@@ -55,6 +56,21 @@ void json_serialise(uint8_t** tokens,
                     ParamValue* values,
                     uint8_t len,
                     uint8_t ctr) {
+    json_write(tokens, values, len, ctr, 1);
+}
+
+uint16_t json_serial_len(uint8_t** tokens,
+                         ParamValue* values,
+                         uint8_t len,
+                         uint8_t ctr) {
+    return json_write(tokens, values, len, ctr, 0);
+}
+
+static uint16_t json_write(uint8_t** tokens,
+                           ParamValue* values,
+                           uint8_t len,
+                           uint8_t ctr,
+                           uint8_t is_sent) {
 
     uint8_t  buf[6];                    /* A local buffer. */
     uint8_t* str        =  buf;         /* String to send. */
@@ -62,6 +78,8 @@ void json_serialise(uint8_t** tokens,
     uint8_t i           =  0;           /* Iteration of @p tokens. */
     uint8_t j;                          /* Pad numbers with white-space. */
     uint8_t flush       =  0;           /* Flush data after sending them. */
+    uint8_t is_spaced   =  !(SERIAL_COMPACT & ctr); /* Add white-space. */
+    uint16_t total      =  0;           /* Bytes produced so far. */
 
     uint8_t state       =  JSON_OBJECT_BEGIN;
 
@@ -74,7 +92,7 @@ void json_serialise(uint8_t** tokens,
                 /* A brace signifies the start of an object. */
                 if(SERIAL_ATOMIC_S & ctr)   buf[k++]    =  0x7b;    /* '{' */
 
-                buf[k++]    =  '\n';
+                if(is_spaced)               buf[k++]    =  '\n';
 
                 /* Initiate a key, if there are key tokens specified. */
                 if(tokens != NULL) {
@@ -96,7 +114,7 @@ void json_serialise(uint8_t** tokens,
 
                 buf[k++]    =  '"';     /* Key-end. */
                 buf[k++]    =  ':';
-                buf[k++]    =  ' ';
+                if(is_spaced)   buf[k++]    =  ' ';
 
                 /* Print a bracket (start of array), if the key corresponds to
                 * an envelope (array) and finish this iteration. */
@@ -120,20 +138,27 @@ void json_serialise(uint8_t** tokens,
             case JSON_VALUE_BEGIN:
                 switch(values[i].type) {
                     case DTYPE_UINT:
+                        k   =  uint_to_str(&buf[5],
+                                   (values[i].status_len & ~PARAM_STATUS_MASK)
+                                   == 16 ? *((uint16_t*)values[i].data_ptr)
+                                         : *((uint8_t*)values[i].data_ptr));
+
+                        /* Print the digits alone, if compact. */
+                        if(!is_spaced) {
+                            str =  &buf[5 - k];
+                            break;
+                        }
+
                         /* Print a total of 5 digits (with padding to fill the
                         * gaps, if needed). */
+                        j   =  5 - k;
                         k   =  5;
 
-                        /* The size of padding. */
-                        j   =  4 - uint_to_str(&buf[5],
-                                             *((uint8_t*)values[i].data_ptr));
-
                         /* Pad with spaces to create a fixed-width number. */
                         while(j) {
-                            buf[j] = ' ';
                             --j;
+                            buf[j] = ' ';
                         }
-                        buf[j] = ' ';
 
                         str =  buf;
 
@@ -173,13 +198,13 @@ void json_serialise(uint8_t** tokens,
                         buf[k++]    =  ',';
                     }
 
-                    buf[k++]    =  '\n';
+                    if(is_spaced)   buf[k++]    =  '\n';
                     buf[k++]    =  '"';     /* Key-start. */
                     state = JSON_KEY_BEGIN;
 
                 } else {
                     if(SERIAL_ATOMIC_E & ctr) {
-                        buf[k++]    =  '\n';
+                        if(is_spaced)   buf[k++]    =  '\n';
                         buf[k++]    =  0x7d;    /* } */
                     }
                     flush       =  SERIAL_FLUSH & ctr;
@@ -189,10 +214,12 @@ void json_serialise(uint8_t** tokens,
                 break;
         }
 
-        net_send(HTTP_SOCKET, str, k, flush);
+        if(is_sent) net_send(get_socket_buf(), str, k, flush);
+        total      +=  k;
 
         k           =  0;
     }
+    return total;
 }
 
 int8_t json_discard_WS(uint8_t* c) {
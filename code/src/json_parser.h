@@ -202,6 +202,10 @@ int8_t json_parse(uint8_t** tokens, ParamValue* values, uint8_t len);
 * For #DTYPE_STRING, the contents of @link ParamValue#data_ptr data_ptr@endlink
 * are copied (within double quotes) until the first occurrence of a null-byte.
 *
+* With #SERIAL_COMPACT, the output is minimal: numbers are not padded, and
+* neither line feeds nor spaces are produced (see json_serial_len() to know its
+* size in advance).
+*
 *an "atomic" is series of key-value pairs (which may be
 *       separated among different calls). 
 *
@@ -220,6 +224,7 @@ int8_t json_parse(uint8_t** tokens, ParamValue* values, uint8_t len);
 *   - #SERIAL_PRECEDED; a separator (comma) will be prefixed before serialising
 *       object key-pairs or an envelope start. It is ignored in case
 *       #SERIAL_ENVELOPE_E without #SERIAL_ENVELOPE_S has been specified.
+*   - #SERIAL_COMPACT; leave out white-space (see above).
 *
 * Examples:
 *   1. Serialise an empty object, flushing after doing so: @verbatim
@@ -280,6 +285,30 @@ Produces:
                       uint8_t len,
                       uint8_t ctr);
 
+/**
+* @brief Returns the amount of bytes json_serialise() would produce for the same
+* arguments, without sending any.
+*
+* This is how a `Content-Length' or the size of a chunk is known before the
+* values are sent. #SERIAL_FLUSH makes no difference.
+*/
+uint16_t json_serial_len(uint8_t** tokens,
+                         ParamValue* values,
+                         uint8_t len,
+                         uint8_t ctr);
+
+/**
+* @brief Serialise, as json_serialise() describes, and send the result, if
+* @p is_sent is non-zero.
+*
+* @returns The amount of bytes produced, whether sent or not.
+*/
+static uint16_t json_write(uint8_t** tokens,
+                           ParamValue* values,
+                           uint8_t len,
+                           uint8_t ctr,
+                           uint8_t is_sent);
+
 /**
 * @brief Advance the stream till a non-white-space character.
 *
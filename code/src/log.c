@@ -1,5 +1,6 @@
 #include "log.h"
 #include "defs.h"
+#include "flash.h"
 #include <avr/eeprom.h>
 
 #include "string.h"
@@ -12,18 +13,6 @@
 */
 uint8_t eeprom_dummy EEMEM;
 
-/**
-* @brief Offset of the first stored record.
-*
-* It spans from @c 0 up to #LOG_LEN - 1.
-*/
-static uint8_t log_index EEMEM = 0;
-
-/**
-* @brief The amount of stored records.
-*/
-static uint8_t log_count EEMEM = 0;
-
 /**
 * @ingroup log
 * @brief Internal Log state.
@@ -34,16 +23,70 @@ static uint8_t log_count EEMEM = 0;
 * log_get_offset() uses this member to map a logical offset to a physical one.
 *
 * @link LogRecordSet#count .count@endlink is the amount of valid Log records.
+*
+* Neither is stored; log_init() recovers them from the records themselves.
 */
 static LogRecordSet log;
 
 void log_init() {
-    log.index   =  eeprom_read_byte(&log_index);
-    log.count   =  eeprom_read_byte(&log_count);
+    BCDDate  dt[FLS_LOG_SECTORS];   /* Date of the first slot of each sector. */
+    uint8_t  oldest =  FLS_LOG_SECTORS; /* Sector of the oldest record. */
+    uint8_t  newest =  FLS_LOG_SECTORS; /* Sector of the newest record. */
+    uint16_t start;                 /* Sub-array lower search limit. */
+    uint16_t end;                   /* Sub-array upper search limit. */
+    uint16_t mid;                   /* Slot of the sector to check. */
+    uint16_t offset;                /* Physical offset of a slot. */
+    uint8_t  year;                  /* Year of the slot at @c offset. */
+    uint8_t  s;
+
+    /* The records are in the order of their dates, and the sectors they take
+    * are either full or the one they end in; so the oldest and the newest
+    * records are in the sectors that begin with the oldest and the newest
+    * date, respectively. */
+    for(s = 0 ; s < FLS_LOG_SECTORS ; ++s) {
+        offset  =  s*LOG_SECTOR_RECORDS;
+        fls_read(LOG_PAGE(offset), LOG_BYTE(offset), (uint8_t*)&dt[s],
+                 sizeof(BCDDate));
+        if(dt[s].year == LOG_FREE) continue;
+
+        if(oldest == FLS_LOG_SECTORS
+        || memcmp(&dt[s], &dt[oldest], sizeof(BCDDate)) < 0) {
+            oldest  =  s;
+        }
+        if(newest == FLS_LOG_SECTORS
+        || memcmp(&dt[s], &dt[newest], sizeof(BCDDate)) > 0) {
+            newest  =  s;
+        }
+    }
+
+    log.index   =  0;
+    log.count   =  0;
+    if(newest == FLS_LOG_SECTORS) return;
+
+    /* Search the sector of the newest record for its first free slot; the
+    * first slot is known to be taken. */
+    start       =  1;
+    end         =  LOG_SECTOR_RECORDS;
+    while(start < end) {
+        mid     =  start + (end - start)/2;
+        offset  =  newest*LOG_SECTOR_RECORDS + mid;
+        fls_read(LOG_PAGE(offset), LOG_BYTE(offset), &year, 1);
+
+        if(year == LOG_FREE) {
+            end     =  mid;
+        } else {
+            start   =  mid + 1;
+        }
+    }
+
+    log.index   =  oldest*LOG_SECTOR_RECORDS;
+    log.count   =  (newest < oldest ? newest + FLS_LOG_SECTORS - oldest
+                                    : newest - oldest)*LOG_SECTOR_RECORDS
+                +  start;
 }
 
-uint8_t log_purge(BCDDate* dt) {
-    uint8_t      count;
+uint16_t log_purge(BCDDate* dt) {
+    uint16_t     count;
     LogRecordSet set;
     BCDDate until   = {.year = 0x99, .mon = 0x12, .date = 0x31,
                        .hour = 0x23, .min = 0x59, .sec  = 0x59};
@@ -52,41 +95,46 @@ uint8_t log_purge(BCDDate* dt) {
     count           =  log_get_set(&set, dt, &until);
     if(count) {
         log.count  -=  count;
-        eeprom_write_byte(&log_count, log.count);
+        log_clear(log_get_offset(log.count), count);
     }
 
-    DBG(printf("Purged records: %d\n", count));
+    DBG(printf("Purged records: %u\n", count));
     return count;
 }
 
 void log_append(LogRecord* rec) {
-    uint8_t     write_offset;   /* Offset from #LOG_BASE_ADDR to write to. */
+    uint16_t    write_offset;   /* Physical offset to write to. */
+    LogRecord   buf;            /* Copy of @p rec; fls_write() alters it. */
 
     /* Remove any records with a newer date than the one in @p rec. */
     log_purge(&rec->date);
 
-    /* If the storage if full, replace the oldest record with this one. */
-    if(log.count == LOG_LEN) {
-        write_offset    =  log.index;
-
-        /* Update the physical offset of the oldest record. */
-        log.index       =  log.index == LOG_LEN - 1 ? 0 : log.index + 1;
-        eeprom_write_byte(&log_index, log.index);
+    write_offset    =  log_get_offset(log.count);
 
-    } else {
-        write_offset    =  log_get_offset(log.index + log.count);
+    /* Erase a sector before writing its first record. Should the storage be
+    * (almost) full, the records it holds are the oldest ones; drop them. */
+    if(write_offset % LOG_SECTOR_RECORDS == 0) {
+        if(log.count > LOG_LEN - LOG_SECTOR_RECORDS) {
 
-        /* Update the count of available records. */
-        ++log.count;
-        eeprom_write_byte(&log_count, log.count);
+            /* Update the physical offset of the oldest record. */
+            log.index   =  write_offset + LOG_SECTOR_RECORDS < LOG_LEN
+                         ? write_offset + LOG_SECTOR_RECORDS : 0;
+            log.count   =  LOG_LEN - LOG_SECTOR_RECORDS;
+        }
+        fls_erase(FLS_SE, LOG_PAGE(write_offset));
     }
 
-    /* Calculate the physical address that corresponds to @c write_offset and
-    * write to it. */
-    eeprom_update_block(rec, (void*)LOG_ADDR(write_offset), sizeof(LogRecord));
+    /* Write the record at the physical address that corresponds to
+    * @c write_offset. */
+    buf             =  *rec;
+    fls_write(LOG_PAGE(write_offset), LOG_BYTE(write_offset), (uint8_t*)&buf,
+              sizeof(LogRecord));
+
+    /* Update the count of available records. */
+    ++log.count;
 }
 
-uint8_t log_skip(LogRecordSet* set, uint8_t amount) {
+uint16_t log_skip(LogRecordSet* set, uint16_t amount) {
     /* Ensure there are enough records to skip. */
     if(set->count > amount) {
         set->index -=  amount;
@@ -100,13 +148,14 @@ uint8_t log_skip(LogRecordSet* set, uint8_t amount) {
 }
 
 uint8_t log_get_next(LogRecord* rec, LogRecordSet* set) {
-    uint8_t     read_offset;
+    uint16_t    read_offset;
 
     /* Read the next record provided there is one. */
     if(set->count && set->index < log.count) {
         read_offset = log_get_offset(set->index);
 
-        eeprom_read_block(rec, (void*)LOG_ADDR(read_offset), sizeof(LogRecord));
+        fls_read(LOG_PAGE(read_offset), LOG_BYTE(read_offset), (uint8_t*)rec,
+                 sizeof(LogRecord));
 
         --(set->index);
         --(set->count);
@@ -116,9 +165,9 @@ uint8_t log_get_next(LogRecord* rec, LogRecordSet* set) {
     return -1;
 }
 
-uint8_t log_get_set(LogRecordSet* set, BCDDate* since, BCDDate* until) {
-    uint8_t i_since;        /* Index of date @p since. */
-    uint8_t i_until;        /* Index of date @p until. */
+uint16_t log_get_set(LogRecordSet* set, BCDDate* since, BCDDate* until) {
+    uint16_t i_since;       /* Index of date @p since. */
+    uint16_t i_until;       /* Index of date @p until. */
     int16_t c_since;        /* Comparison result of date @p since. */
     int16_t c_until;        /* Comparison result of date @p until. */
 
@@ -140,7 +189,7 @@ uint8_t log_get_set(LogRecordSet* set, BCDDate* since, BCDDate* until) {
     * upper and lower limits point at the same index and their respective
     * dates are both either greater or less than the date at that index. */
     if(i_since == i_until &&
-      (c_since & 0x80) == (c_until & 0x80) && c_since != 0 && c_until != 0) {
+      (c_since < 0) == (c_until < 0) && c_since != 0 && c_until != 0) {
 
     /* Determine whether the limits need to be adjusted. */
     } else {
@@ -159,20 +208,21 @@ uint8_t log_get_set(LogRecordSet* set, BCDDate* since, BCDDate* until) {
     return set->count;
 }
 
-static int16_t log_find(uint8_t* index, BCDDate* q) {
-    int16_t start   =  0;           /* Sub-array lower search limit. */
-    int16_t end     =  log.count - 1; /* Sub-array upper search limit. */
+static int16_t log_find(uint16_t* index, BCDDate* q) {
+    int16_t  start  =  0;           /* Sub-array lower search limit. */
+    int16_t  end    =  log.count - 1; /* Sub-array upper search limit. */
 
-    BCDDate dt;                     /* Loaded record date. */
-    int16_t cmp;                    /* Comparison result. */
+    BCDDate  dt;                    /* Loaded record date. */
+    int16_t  cmp;                   /* Comparison result. */
+    uint16_t offset;                /* Physical offset of @c dt. */
 
     while(end >= start) {
         *index  =  start + (end - start)/2;
 
         /* Load date for the physical offset that corresponds to @c i. */
-        eeprom_read_block(&dt,
-                          (void*)LOG_ADDR(log_get_offset(*index)),
-                          sizeof(BCDDate));
+        offset  =  log_get_offset(*index);
+        fls_read(LOG_PAGE(offset), LOG_BYTE(offset), (uint8_t*)&dt,
+                 sizeof(BCDDate));
 
         cmp     =  memcmp(q, &dt, sizeof(BCDDate));
 
@@ -190,8 +240,8 @@ static int16_t log_find(uint8_t* index, BCDDate* q) {
     return cmp;
 }
 
-static uint8_t log_get_offset(uint8_t index) {
-    uint8_t offset;
+static uint16_t log_get_offset(uint16_t index) {
+    uint16_t offset;
 
     /* The requested item lies within #log.index and LOG_LEN - 1. */
     if(LOG_LEN - log.index > index) {
@@ -204,3 +254,33 @@ static uint8_t log_get_offset(uint8_t index) {
 
     return offset;
 }
+
+static void log_clear(uint16_t offset, uint16_t count) {
+    uint8_t  blank[sizeof(LogRecord)];
+    uint16_t cleared;               /* Slots cleared in one go. */
+
+    while(count) {
+        /* The slots past @p count in the same sector are already free, so
+        * whole sectors and pages may be erased. */
+        if(offset % LOG_SECTOR_RECORDS == 0) {
+            fls_erase(FLS_SE, LOG_PAGE(offset));
+            cleared =  LOG_SECTOR_RECORDS;
+
+        } else if(offset % LOG_PAGE_RECORDS == 0) {
+            fls_erase(FLS_PE, LOG_PAGE(offset));
+            cleared =  LOG_PAGE_RECORDS;
+
+        /* Otherwise, overwrite a single slot. fls_write() alters @c blank. */
+        } else {
+            memset(blank, LOG_FREE, sizeof(blank));
+            fls_write(LOG_PAGE(offset), LOG_BYTE(offset), blank,
+                      sizeof(blank));
+            cleared =  1;
+        }
+
+        if(cleared > count) cleared = count;
+        count      -=  cleared;
+        offset     +=  cleared;
+        if(offset == LOG_LEN) offset = 0;
+    }
+}
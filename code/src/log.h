@@ -3,18 +3,28 @@
 * @addtogroup log Measurement Log
 * @brief Manage measurement logging.
 *
-* The records are stored within EEPROM in a circular structure that,
-* essentially, is a simplified circular buffer. Its contents span from address
-* #LOG_BASE_ADDR for a total of #LOG_LEN records. The size and contents of each
-* record is determined by #LogRecord.
-*
-* The chosen structure permits adding new records that, once the available space
-* has been depleted, replace the oldest ones. To achieve this, the offset of the
-* oldest record and the current amount of records are maintained (see #log).
-* Obviously, this offset is incremented as older records are being replaced.
-* Offsets that are calculated based on this start offset are referred to as
-* 'physical offsets' because they may be used to obtain the physical address of
-* a particular record.
+* The records are stored within the external Flash in a circular structure
+* that, essentially, is a simplified circular buffer. It spans the
+* #FLS_LOG_SECTORS sectors from page #FLS_LOG_PAGE onwards, each page holding
+* #LOG_PAGE_RECORDS records (a record never spans two pages), for a total of
+* #LOG_LEN records. The size and contents of each record is determined by
+* #LogRecord.
+*
+* Records are only ever appended. Before the first record of a sector is
+* written, the whole sector is erased (#FLS_SE); this drops the records it still
+* holds, which are the oldest ones, a sector at a time. So, at least #LOG_LEN -
+* #LOG_SECTOR_RECORDS records are always kept, once as many have been appended.
+* To achieve this, the offset of the oldest record and the current amount of
+* records are maintained (see #log). Offsets that are calculated based on this
+* start offset are referred to as 'physical offsets' because they may be used to
+* obtain the physical address of a particular record (see #LOG_PAGE and
+* #LOG_BYTE).
+*
+* The offset and the amount are not stored anywhere, lest the same cells are
+* rewritten with every record. Since records are appended in the order of their
+* dates (see log_append()), and slots that hold no record are free (see
+* #LOG_FREE), log_init() recovers them from the first slot of each sector and
+* a binary search within the sector of the newest record.
 *
 * To avoid the implementation specifics and the manipulation of a circular
 * structure in higher abstraction functions, such as log_get_set() and
@@ -32,13 +42,41 @@
 #define LOG_H_INCL
 
 #include "defs.h"
+#include "flash.h"
 
 #include <inttypes.h>
 
 /**
-* @brief Shorthand to calculate the address of a physical offset.
+* @brief Amount of records in a page of the Flash.
 */
-#define LOG_ADDR(offset)   (LOG_BASE_ADDR + offset*sizeof(LogRecord))
+#define LOG_PAGE_RECORDS    (256/sizeof(LogRecord))
+
+/**
+* @brief Amount of records in a sector of the Flash.
+*/
+#define LOG_SECTOR_RECORDS  (FLS_SECTOR_PAGES*LOG_PAGE_RECORDS)
+
+/**
+* @brief The amount of total records the Log may hold.
+*/
+#define LOG_LEN             (FLS_LOG_SECTORS*LOG_SECTOR_RECORDS)
+
+/**
+* @brief Year of a slot that holds no record.
+*
+* This is the year of an erased slot; no BCD year is ever this.
+*/
+#define LOG_FREE            0xFF
+
+/**
+* @brief Shorthand to calculate the page of a physical offset.
+*/
+#define LOG_PAGE(offset)    (FLS_LOG_PAGE + (offset)/LOG_PAGE_RECORDS)
+
+/**
+* @brief Shorthand to calculate the byte within its page of a physical offset.
+*/
+#define LOG_BYTE(offset)    (((offset)%LOG_PAGE_RECORDS)*sizeof(LogRecord))
 
 /**
 * @brief Index of a single record and the total amount of records.
@@ -54,10 +92,10 @@ typedef struct {
     *
     * It spans from @c 0 up to #LOG_LEN - 1.
     */
-    uint8_t index;
+    uint16_t index;
 
     /** @brief Amount of records. */
-    uint8_t count;
+    uint16_t count;
 } LogRecordSet;
 
 /**
@@ -89,28 +127,29 @@ typedef struct {
 /**
 * @brief Initialise Log dependencies.
 *
-* It loads @c index and @c count from EEPROM into #log.
+* It recovers @c index and @c count of #log from the Flash. Besides the first
+* slot of each sector, about log2(#LOG_SECTOR_RECORDS) slots are read.
 */
 void log_init();
 
 /**
 * @brief Remove records newer than @p dt.
 *
-* This simply updates (decreases) an internal counter; the actual records are
-* not erased from the EEPROM but are ignored and successively overwritten with
-* each call to log_append().
+* Apart from updating (decreasing) an internal counter, the slots of the records
+* are freed (see log_clear()), so that log_init() does not recover them.
 *
 * @param[in] dt The starting date. Records with a date equal or greater than
 *   this value, will be purged.
 * @returns The number of records deleted.
 */
-uint8_t log_purge(BCDDate* dt);
+uint16_t log_purge(BCDDate* dt);
 
 /**
 * @brief Add a new log record.
 *
-* Apart from writing the record, it also updates @c index, @c count (in EEPROM)
-* and #log, as needed.
+* Apart from writing the record, it also updates #log, as needed. Should the
+* record be the first of a sector, the sector is erased beforehand, dropping the
+* records it holds.
 *
 * @param[in] rec The record to append to the log.
 */
@@ -123,7 +162,7 @@ void log_append(LogRecord* rec);
 * @param[in] amount Amount of records to skip.
 * @returns The amount of available records after skipping.
 */
-uint8_t log_skip(LogRecordSet* set, uint8_t amount);
+uint16_t log_skip(LogRecordSet* set, uint16_t amount);
 
 /**
 * @brief Read the next record found in the record @p set.
@@ -157,12 +196,12 @@ uint8_t log_get_next(LogRecord* rec, LogRecordSet* set);
 * @param[in] until The ending date of the returned records (inclusive).
 * @returns Amount of records to be returned with this set.
 */
-uint8_t log_get_set(LogRecordSet* set, BCDDate* since, BCDDate* until);
+uint16_t log_get_set(LogRecordSet* set, BCDDate* since, BCDDate* until);
 
 /**
 * @brief Locate the closest record index to the supplied date.
 *
-* It implements a simple binary search algorithm to avoid unnecessary EEPROM
+* It implements a simple binary search algorithm to avoid unnecessary Flash
 * reads. It uses <string.h>memcmp() for the date comparisons. If a record with
 * the specified date is not found, the closest logical offset is returned,
 * instead.
@@ -175,7 +214,19 @@ uint8_t log_get_set(LogRecordSet* set, BCDDate* since, BCDDate* until);
 * @param[in] q The date of the record in question.
 * @returns The output of memcmp() of the last comparison.
 */
-static int16_t log_find(uint8_t* index, BCDDate* q);
+static int16_t log_find(uint16_t* index, BCDDate* q);
+
+/**
+* @brief Free @p count slots starting from physical offset @p offset.
+*
+* The slots that follow these in the same sector must already be free. Whole
+* sectors (#FLS_SE) and pages (#FLS_PE) are erased; the rest of the slots are
+* overwritten one at a time.
+*
+* @param[in] offset The physical offset of the first slot.
+* @param[in] count The amount of slots to free.
+*/
+static void log_clear(uint16_t offset, uint16_t count);
 
 /**
 * @brief Translate a logical to a physical offset.
@@ -188,7 +239,7 @@ static int16_t log_find(uint8_t* index, BCDDate* q);
 *   that lies outside the storage may be returned.
 * @returns The physical offset that may be used to access a record.
 */
-static uint8_t log_get_offset(uint8_t index);
+static uint16_t log_get_offset(uint16_t index);
 
 #endif /* LOG_H_INCL */
 /** @} */
@@ -15,6 +15,7 @@
 #endif
 
 #include "task.h"
+#include "event.h"
 #include "motor.h"
 #include "twi.h"
 #include "rtc.h"
@@ -114,13 +115,12 @@ int main() {
     /* Set both Change Enable *and* System Reset Mode bits to enable setting the
     * timeout. Then, the WDT is set to Interrupt (only) mode. This way, at
     * #WDT_TIMEOUT intervals, the CPU will be woken from power-down mode. The
-    * WDT ISR checks whether sampling should be initiated. Once execution
-    * returns to the main loop, the CPU goes to power-down, again. The CPU maybe
-    * woken at any time by other sources, as well, such as a limit switch and/or
-    * an incoming HTTP request. Those requests could delay the CPU for as long
-    * they require with no fear of the WDT timeout; since the System Reset Mode
-    * is not activated, the WDT Interrupt will simply be queued, if it occurs
-    * before any previously activated ISR returns. */
+    * main loop checks whether sampling should be initiated. Once done, the CPU
+    * goes to power-down, again. The CPU maybe woken at any time by other
+    * sources, as well, such as a limit switch and/or an incoming HTTP request.
+    * Those requests could delay the CPU for as long they require with no fear
+    * of the WDT timeout; since the System Reset Mode is not activated, the WDT
+    * Interrupt will simply be posted as an event for the main loop. */
     WDTCSR  =  _BV(WDCE) | _BV(WDE);
     WDTCSR  =  _BV(WDCE) | _BV(WDIE) | (WDT_TIMEOUT & (_BV(WDP3)
                                                      | _BV(WDP2)
@@ -130,11 +130,22 @@ int main() {
     sei();
 
     while(1) {
-        if(!task_pending()) {
+        /* Handle whatever the ISRs have posted (see evt_post()). */
+        evt_dispatch();
+
+        /* Sleep, unless more events have been posted in the meantime or the
+        * motors are in operation (their timers need the clock). Interrupts are
+        * disabled while checking, lest an event be posted right before going
+        * to sleep; the instruction following sei() is always executed before
+        * any pending interrupt, so such an interrupt wakes the CPU at once. */
+        cli();
+        if(!evt_pending() && !task_pending()) {
             sleep_enable();
+            sei();
             sleep_cpu();
             sleep_disable();
         }
+        sei();
     }
 
     return 0;
@@ -216,6 +227,8 @@ static void init() {
                             0, 0};      /* Task defaults are to disable it. */
     Position max;
     Task    task;
+    uint8_t imr =  0;   /* Sockets to enable interrupts for. */
+    uint8_t i;
 
     uint8_t rtc_sec;
     rtc_read(0, &rtc_sec, 1);
@@ -242,9 +255,16 @@ static void init() {
     task.samples    =  settings[SYS_TASK_SAMPL  - RTC_BASE];
 
     /* Network module */
-    /* Setup buffer size. #HTTP_SOCKET is configured to 8KB on Tx and Rx). */
-    net_socket_init(NET_SIZEn(HTTP_SOCKET, NET_SIZE_8),
-                    NET_SIZEn(HTTP_SOCKET, NET_SIZE_8));
+    /* Setup buffer size. Each socket is configured to #HTTP_SOCKET_SIZE on Tx
+    * and Rx. */
+    net_socket_init(NET_SIZEn(0, HTTP_SOCKET_SIZE)
+                  | NET_SIZEn(1, HTTP_SOCKET_SIZE)
+                  | NET_SIZEn(2, HTTP_SOCKET_SIZE)
+                  | NET_SIZEn(3, HTTP_SOCKET_SIZE),
+                    NET_SIZEn(0, HTTP_SOCKET_SIZE)
+                  | NET_SIZEn(1, HTTP_SOCKET_SIZE)
+                  | NET_SIZEn(2, HTTP_SOCKET_SIZE)
+                  | NET_SIZEn(3, HTTP_SOCKET_SIZE));
 
     /* Pass server settings to the W5100 and the HTTP server module. */
     srvr_set_host_name_ip(  &settings[SYS_IADDR -   RTC_BASE]);
@@ -256,12 +276,13 @@ static void init() {
     /* Mode register (MR) defaults look OK. The same applies for RTR (200ms
     * intervals) and RCR (8 retries). */
 
-    /* Enable interrupts on HTTP_SOCKET. */
-    net_write8(NET_IMR, NET_IR_Sn(HTTP_SOCKET));
-
-    /* Setup #HTTP_SOCKET for HTTP (TCP on port #HTTP_PORT). */
-    net_socket_open(HTTP_SOCKET, NET_Sn_MR_TCP, HTTP_PORT);
-    net_write8(NET_Sn_CR(HTTP_SOCKET), NET_Sn_CR_LISTEN);
+    /* Enable interrupts on all HTTP sockets and have them listen to
+    * #HTTP_PORT. */
+    for(i = 0 ; i < HTTP_SOCKETS ; ++i) {
+        imr    |=  NET_IR_Sn(i);
+        listen_http_socket(i);
+    }
+    net_write8(NET_IMR, imr);
 
     /* Other modules; complementary ones, first. */
     rsrc_init();
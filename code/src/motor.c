@@ -1,5 +1,6 @@
 
 #include "motor.h"
+#include "clock.h"
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
@@ -90,6 +91,7 @@ void motor_set_callback(void (*callback)(Position pos, uint8_t event)) {
 }
 
 void motor_reset() {
+    clk_slow();
 
     /* Begin with resetting axis Z if no reset is already in progress. It is
     * imperative to first retract on axis Z separately from the others. Once
@@ -177,6 +179,8 @@ int8_t motor_set(Position target) {
 
     new_pos     =  target;
 
+    /* The PWM and the step counter are timed at #F_CPU. */
+    clk_slow();
     return motor_update();
 }
 
@@ -2,35 +2,181 @@
 #include "defs.h"
 #include "w5100.h"
 #include "http_server.h"
+#include "event.h"
+#include "sbuffer.h"
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
 /**
-* @brief Propagates interrupts from the W5100 to the appropriate handlers.
+* @brief Requests served on the current connection of each HTTP socket.
+*/
+static uint8_t http_requests[HTTP_SOCKETS];
+
+/**
+* @brief Watchdog periods each HTTP socket has been idle for.
+*/
+static uint8_t http_idle[HTTP_SOCKETS];
+
+/**
+* @brief HTTP sockets to close once their response has been sent; a bit per
+* socket.
+*/
+static uint8_t http_closing;
+
+/**
+* @brief Bytes of an incomplete request head scanned so far on each HTTP socket;
+* @c 0, if none is pending (see is_http_head_complete()).
+*/
+static uint16_t http_scanned[HTTP_SOCKETS];
+
+/**
+* @brief Bytes of the empty line that ends a head (CR LF CR LF) found last by
+* the scan of each HTTP socket.
+*/
+static uint8_t http_crlf[HTTP_SOCKETS];
+
+/**
+* @brief Returns non-zero if any HTTP socket other than @p s is listening.
+*
+* A connection is only kept alive while this holds, so that new clients are
+* never locked out by idle ones.
+*/
+static uint8_t is_http_listening(uint8_t s) {
+    uint8_t i;
+
+    for(i = 0 ; i < HTTP_SOCKETS ; ++i) {
+        if(i != s && net_read8(NET_Sn_SR(i)) == NET_Sn_SR_LISTEN) return 1;
+    }
+    return 0;
+}
+
+/**
+* @brief Returns non-zero if @p tail is the empty line that ends a request head,
+* preceded by the CRLF of the last header.
+*/
+static uint8_t is_head_end(uint8_t* tail) {
+    return tail[0] == '\r' && tail[1] == '\n'
+        && tail[2] == '\r' && tail[3] == '\n';
+}
+
+/**
+* @brief Returns non-zero if the head of the next request on socket @p s, as
+* set with set_socket_buf(), has arrived whole or is larger than #HTTP_HEAD_MAX.
+*
+* Most requests arrive whole and without a body; their data end with an empty
+* line, which is all that is checked. Otherwise, the data are scanned in the
+* input buffer of the W5100 for the end of the head, picking up from where the
+* previous call for the same request left off. Nothing is read from the socket
+* either way; the request is parsed once this holds. The first time it does not,
+* the deadline of the request (#HTTP_REQUEST_TIMEOUT) starts.
+*/
+static uint8_t is_http_head_complete(uint8_t s) {
+    uint8_t  buf[16];
+    uint16_t pos    =  http_scanned[s];
+    uint8_t  crlf   =  http_crlf[s];
+    uint8_t  done;
+    uint16_t len;
+    uint8_t  i;
+
+    done    =  !s_tail(buf, 4) && is_head_end(buf);
+    if(!done && !pos) http_idle[s] = 0;
+
+    while(!done && (len = net_peek(s, pos, buf, sizeof(buf))) > 0) {
+        for(i = 0 ; i < len && !done ; ++i) {
+            if(buf[i] == (crlf & 1 ? '\n' : '\r')) {
+                ++crlf;
+            } else {
+                crlf    =  buf[i] == '\r';
+            }
+
+            done    =  crlf == 4 || pos + i >= HTTP_HEAD_MAX;
+        }
+        pos    +=  len;
+    }
+
+    /* Once it holds, the scan of the next request starts afresh. */
+    http_scanned[s] =  done ? 0 : pos;
+    http_crlf[s]    =  done ? 0 : crlf;
+    return done;
+}
+
+/**
+* @brief Closes the connection of socket @p s once its response has been sent.
 *
-* This ISR reads the #NET_IR to determine the socket source and calls the
-* appropriate handler. Currently, only one socket operates, which is responsible
-* for the HTTP server transactions (see handle_http_socket()). Upon invoking the
-* handler, the ISR keeps a copy of the socket's interrupt register (#NET_Sn_IR)
-* and passes its value as an argument. The handler is supposed to respond to the
-* specified flags only. Once completed, the ISR will clear the interrupt flag
-* bits that were specified to the handler. If more interrupt flag bits have been
-* set in the meantime, the ISR will be ready to respond to them.
+* A DISCON interrupt follows once the peer agrees.
+*/
+static void close_http_socket(uint8_t s) {
+    if(net_is_sending(s)) {
+        http_closing   |=  _BV(s);
+    } else {
+        net_write8(NET_Sn_CR(s), NET_Sn_CR_DISCON);
+    }
+}
+
+/**
+* @brief Defers interrupts from the W5100 to the main loop.
+*
+* The interrupt is masked until handle_net_interrupt() has dealt with it; being
+* level-triggered, it would otherwise fire again as soon as this ISR returns.
 */
 ISR(INT1_vect) {
+    EIMSK      &= ~_BV(INT1);
+    evt_post(EVT_NET);
+}
+
+void handle_net_interrupt() {
     uint8_t status = net_read8(NET_IR);
     uint8_t socket;
+    uint8_t s;
 
-    /* Only HTTP_SOCKET interrupts are of interest; clear high nibble. */
+    /* Only Socket interrupts are of interest; clear high nibble. */
     net_write8(NET_IR, 0xE0);
 
-    if(bit_is_set(status, HTTP_SOCKET)) {
-        socket  =  net_read8(NET_Sn_IR(HTTP_SOCKET));
-        handle_http_socket(HTTP_SOCKET, socket);
+    for(s = 0 ; s < HTTP_SOCKETS ; ++s) {
+        if(bit_is_clear(status, s)) continue;
+
+        socket  =  net_read_ir(s);
+        handle_http_socket(s, socket);
+
+        /* Clear Socket interrupt flags that have just been dealt with.
+        * #NET_Sn_IR_SEND_OK is already cleared by net_read_ir(). */
+        net_write8(NET_Sn_IR(s), socket & ~_BV(NET_Sn_IR_SEND_OK));
+    }
+
+    /* Any interrupt raised in the meantime is still asserted. */
+    EIMSK      |=  _BV(INT1);
+}
+
+void listen_http_socket(uint8_t s) {
+    http_requests[s]    =  0;
+    http_idle[s]        =  0;
+    http_closing       &= ~_BV(s);
+    http_scanned[s]     =  0;
+    http_crlf[s]        =  0;
+
+    net_socket_open(s, NET_Sn_MR_TCP, HTTP_PORT);
+    net_write8(NET_Sn_CR(s), NET_Sn_CR_LISTEN);
+}
+
+void tick_http_sockets() {
+    uint8_t s;
 
-        /* Clear Socket interrupt flags that have just been dealt with. */
-        net_write8(NET_Sn_IR(HTTP_SOCKET), socket);
+    for(s = 0 ; s < HTTP_SOCKETS ; ++s) {
+        if(net_read8(NET_Sn_SR(s)) != NET_Sn_SR_ESTAB) continue;
+
+        /* A request has begun but not completed in time. */
+        if(http_scanned[s]) {
+            if(++http_idle[s] >= WDT_TICKS(HTTP_REQUEST_TIMEOUT)) {
+                http_scanned[s] =  0;
+                set_socket_buf(s);
+                srvr_reject(TXB_408);
+                close_http_socket(s);
+            }
+
+        } else if(++http_idle[s] >= WDT_TICKS(HTTP_KEEP_ALIVE_IDLE)) {
+            net_write8(NET_Sn_CR(s), NET_Sn_CR_DISCON);
+        }
     }
 }
 
@@ -39,22 +185,59 @@ void handle_http_socket(uint8_t s, uint8_t status) {
     /* Data available. */
     if(bit_is_set(status, NET_Sn_IR_RECV)) {
 
-        if(net_read16(NET_Sn_RX_RSR(s)) > 0 ) {
+        /* Stream data from this Socket to local (host) buffering. A request
+        * that has only partly arrived is left in the socket, until the rest
+        * of its head does or its time runs out (see tick_http_sockets()). */
+        set_socket_buf(s);
+
+        if(net_rx_size(s) > 0 && is_http_head_complete(s)) {
             uint8_t c;      /* Discarded character. */
             int8_t  c_type;
+            uint8_t keep;   /* Whether the connection persists. */
+
+            /* Service HTTP requests in the order they have arrived; a client
+            * may send several before awaiting any response (pipelining). */
+            do {
+                /* The last request allowed on a connection closes it; so does
+                * any request while no other socket is available to new
+                * clients. */
+                keep    =  ++http_requests[s] < HTTP_KEEP_ALIVE_MAX
+                        && is_http_listening(s);
+
+                keep    =  srvr_call(keep);
+                if(!keep) break;
 
-            /* Stream data from this Socket to local (host) buffering. */
-            set_socket_buf(s);
+                /* Part of the next request may already be buffered; leave it in
+                * the socket. It is only served once its head has arrived
+                * whole; until then, it waits for the next RECV or its time
+                * runs out, like any other request. */
+                s_release();
+            } while(net_rx_size(s) > 0 && is_http_head_complete(s));
 
-            /* Service HTTP request. */
-            srvr_call();
+            /* Discard the remainder of the request(s), if closing. */
+            if(!keep) {
+                while((c_type = s_next(&c)) != -1) {
+                }
+                s_release();
 
-            /* Discard the remainder of the request. */
-            while((c_type = s_next(&c)) != -1) {
+                /* A peer that has stopped reading would never let the rest of
+                * the response through; the connection is dropped at once. */
+                if(net_is_lost(s)) {
+                    listen_http_socket(s);
+                } else {
+                    close_http_socket(s);
+                }
             }
+            http_idle[s]    =  0;
         }
     }
 
+    /* The last of a response has been sent. */
+    if(bit_is_set(status, NET_Sn_IR_SEND_OK) && bit_is_set(http_closing, s)) {
+        http_closing   &= ~_BV(s);
+        net_write8(NET_Sn_CR(s), NET_Sn_CR_DISCON);
+    }
+
     /* Occurs when a connection termination is requested OR completed. */
     if(bit_is_set(status, NET_Sn_IR_DISCON)) {
         uint8_t sn_SR   =  net_read8(NET_Sn_SR(s));
@@ -67,13 +250,17 @@ void handle_http_socket(uint8_t s, uint8_t status) {
             net_write8(NET_Sn_CR(s), NET_Sn_CR_CLOSE);
 
             /* Re-open socket. */
-            net_socket_open(HTTP_SOCKET, NET_Sn_MR_TCP, HTTP_PORT);
-            net_write8(NET_Sn_CR(s), NET_Sn_CR_LISTEN);
+            listen_http_socket(s);
         }
 
     }
     if(bit_is_set(status, NET_Sn_IR_TIMEOUT)) {
         net_write8(NET_Sn_CR(s), NET_Sn_CR_DISCON);
+
+        /* The socket is closed by now (*WIZnet p.29*); have it listen again,
+        * lest the server stops accepting connections. */
+        net_write8(NET_Sn_CR(s), NET_Sn_CR_CLOSE);
+        listen_http_socket(s);
     }
 }
 
@@ -8,15 +8,62 @@
 #include <inttypes.h>
 
 /**
-* @brief Responsible for dealing with interrupts on #HTTP_SOCKET.
+* @brief Propagates interrupts from the W5100 to the appropriate handlers.
+*
+* Called from the main loop, once @c INT1 has been asserted (see #EVT_NET). It
+* reads the #NET_IR to determine the socket sources and calls the appropriate
+* handler of each. Currently, sockets @c 0 up to #HTTP_SOCKETS-1 all serve HTTP
+* transactions (see handle_http_socket()), one after the other. Upon invoking
+* the handler, it keeps a copy of the socket's interrupt register (#NET_Sn_IR)
+* and passes its value as an argument. The handler is supposed to respond to the
+* specified flags only. Once completed, the interrupt flag bits that were
+* specified to the handler are cleared and @c INT1 is unmasked. If more
+* interrupt flag bits have been set in the meantime, @c INT1 fires again.
+*/
+void handle_net_interrupt();
+
+/**
+* @brief Responsible for dealing with interrupts on an HTTP socket (see
+* #HTTP_SOCKETS).
 *
 * It handles the various TCP states and calls srvr_call() when data are
-* available. It is also responsible to reopen the socket, once a connection has
-* been terminated.
+* available, once for each request that has arrived (pipelining). A request is
+* only parsed once its head (request-line and headers) has arrived whole, so
+* that a client sending it a little at a time holds up neither the parser nor
+* the other sockets; it is given #HTTP_REQUEST_TIMEOUT to do so. The same holds
+* for a pipelined request that has only partly arrived behind another; what has
+* arrived of it is left in the socket meanwhile (see s_release()). Connections
+* persist across requests, up to #HTTP_KEEP_ALIVE_MAX of them, unless the
+* requester asks otherwise or there is no other socket left to accept new
+* connections; it closes them, otherwise, as soon as the response has been sent
+* (see #NET_Sn_IR_SEND_OK). A connection whose peer has stopped reading (see
+* #NET_TX_TIMEOUT) is dropped at once, instead. It is also responsible to reopen
+* the socket, once a connection has been terminated.
 *
 * @param[in] s This Socket (@c 0--@c 3).
 * @param[in] status The #NET_Sn_IR value at the time of invocation.
 */
 void handle_http_socket(uint8_t s, uint8_t status);
 
+/**
+* @brief (Re)opens socket @p s for TCP on #HTTP_PORT and has it listen for a
+* connection.
+*
+* Any connection of the socket is dropped.
+*
+* @param[in] s This Socket (@c 0--@c 3).
+*/
+void listen_http_socket(uint8_t s);
+
+/**
+* @brief Closes connections that have been idle for too long.
+*
+* To be called at #WDT_TIMEOUT intervals. Connections with no requests for
+* #HTTP_KEEP_ALIVE_IDLE seconds are closed (the socket listens again once the
+* peer agrees; see handle_http_socket()). So are those with a request still
+* incomplete after #HTTP_REQUEST_TIMEOUT seconds, only they are sent a 408
+* (Request Timeout) first. Either time is counted in calls (see #WDT_TICKS()).
+*/
+void tick_http_sockets();
+
 #endif /* NET_H_INCL */
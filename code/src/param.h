@@ -236,6 +236,16 @@ typedef struct {
 #define PARAM_UINT8(x) \
 {.type = DTYPE_UINT, .data_ptr = &x, .status_len = 8}
 
+/**
+* @brief Facilitates initialisation of a 16-bit #DTYPE_UINT #ParamValue.
+*
+* Such values are only serialised; they are not parsed (yet).
+*
+* @param[in] x The variable (and *not* its address) to serialise.
+*/
+#define PARAM_UINT16(x) \
+{.type = DTYPE_UINT, .data_ptr = &x, .status_len = 16}
+
 /**
 * @brief Facilitates initialisation of a #DTYPE_STRING #ParamValue.
 *
@@ -277,6 +287,11 @@ typedef struct {
 */
 #define SERIAL_PRECEDED        (1 << 2)
 
+/**
+* @brief Directive to leave out any optional white-space.
+*/
+#define SERIAL_COMPACT         (1 << 1)
+
 /**
 * @brief Directive to serialise and flush parameters as one complete group.
 */
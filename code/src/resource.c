@@ -3,15 +3,25 @@
 /* See #include "resource_handlers.inc" further below. */
 #include "param.h"
 #include "http_server.h"
+#include "flash.h"
+
+#include <avr/io.h>
 
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 
 /**
 * @ingroup resource
-* @brief The number of token-handler pairs in #rsrc_handlers.
+* @brief The number of token-handler pairs of the firmware itself.
+*/
+#define RSRC_FW_LEN 4
+
+/**
+* @ingroup resource
+* @brief The maximum number of token-handler pairs in #rsrc_handlers.
 */
-#define RSRC_LEN    9
+#define RSRC_LEN    (RSRC_FW_LEN + RSRC_FILES_MAX)
 
 /**
 * @ingroup resource
@@ -31,11 +41,27 @@ static int8_t (*parser)(uint8_t**, ParamValue*, uint8_t);
 */
 static void (*serialiser)(uint8_t**, ParamValue*, uint8_t, uint8_t);
 
+/**
+* @ingroup resource
+* @brief Function pointer to the size of the output of #serialiser.
+*
+* It is set along with #serialiser, using rsrc_set_serial().
+*/
+static uint16_t (*serial_len)(uint8_t**, ParamValue*, uint8_t, uint8_t);
+
+/**
+* @ingroup resource
+* @brief The entry of the asset directory for each resource in #rsrc_tokens
+* served by rsrc_handle_file().
+*/
+static uint8_t rsrc_files[RSRC_LEN];
+
 /*
 * This module is divided into two parts; this file, containing common base
 * functions, and resource_handlers.inc containing the definition of each
-* resource handler. The latter is included after #parser and #serialiser have
-* been declared because they are needed in the included source code.
+* resource handler. The latter is included after #parser, #serialiser,
+* #serial_len and #rsrc_files have been declared because they are needed in the
+* included source code.
 * resource_handlers.inc should not be compiled separately.
 */
 #include "resource_handlers.inc"
@@ -43,29 +69,97 @@ static void (*serialiser)(uint8_t**, ParamValue*, uint8_t, uint8_t);
 /**
 * @ingroup resource
 * @brief Absolute path tokens of resources exposed by the HTTP server.
+*
+* The resources of the firmware (see #rsrc_fw_tokens) and the assets of the
+* Flash, in ascending order, as required by the HTTP parser. Set up by
+* rsrc_init().
+*/
+static uint8_t* rsrc_tokens[RSRC_LEN];
+
+/**
+* @ingroup resource
+* @brief Available methods and corresponding handlers for each resource.
+*
+* This array and #rsrc_tokens are correlated through srvr_set_resources().
 */
-static uint8_t* rsrc_tokens[RSRC_LEN] = {
+static ResourceHandler rsrc_handlers[RSRC_LEN];
+
+/**
+* @ingroup resource
+* @brief The paths of the assets that #rsrc_tokens point to.
+*/
+static uint8_t rsrc_paths[RSRC_PATHS_LEN];
+
+/**
+* @ingroup resource
+* @brief Absolute path tokens of the resources of the firmware.
+*/
+static uint8_t* rsrc_fw_tokens[RSRC_FW_LEN] = {
     "*",
-    "/",
-    "/client.js",
     "/configuration",
     "/coordinates",
-    "/index",
-    "/logo.png",
-    "/measurement",
-    "/style.css"
+    "/measurement"
 };
 
 /**
 * @ingroup resource
-* @brief Available methods and corresponding handlers for each resource.
-*
-* This array and #rsrc_tokens are correlated through srvr_set_resources().
+* @brief Available methods and corresponding handlers for each of
+* #rsrc_fw_tokens.
 */
-static ResourceHandler rsrc_handlers[RSRC_LEN]; /* Definition is in the end. */
+/* Definition is in the end. */
+static ResourceHandler rsrc_fw_handlers[RSRC_FW_LEN];
 
 void rsrc_init() {
-    srvr_set_resources(rsrc_tokens, rsrc_handlers, RSRC_LEN);
+    uint8_t len     =  0;   /* Resources registered so far. */
+    uint8_t used    =  0;   /* Bytes of #rsrc_paths used so far. */
+    uint8_t count   =  fls_toc_count();
+    uint8_t i;
+
+    for(i = 0 ; i < RSRC_FW_LEN ; ++i) {
+        rsrc_add(len++, rsrc_fw_tokens[i], &rsrc_fw_handlers[i], 0);
+    }
+
+    for(i = 0 ; i < count ; ++i) {
+        FlsEntry entry;
+        uint8_t  size;      /* Of the path, including null-byte. */
+        ResourceHandler file = {.methods = HTTP_GET,
+                                .call    = &rsrc_handle_file};
+
+        fls_toc_entry(i, &entry);
+        entry.path[FLS_PATH_LEN - 1]    =  '\0';
+        size    =  strlen(entry.path) + 1;
+
+        /* pack rejects such images; one written otherwise is served in part. */
+        if(len == RSRC_LEN) {
+            DBG(printf("Asset dropped (RSRC_FILES_MAX): %s\n", entry.path));
+            continue;
+        }
+        if(used + size > RSRC_PATHS_LEN) {
+            DBG(printf("Asset dropped (RSRC_PATHS_LEN): %s\n", entry.path));
+            continue;
+        }
+
+        memcpy(&rsrc_paths[used], entry.path, size);
+        rsrc_add(len++, &rsrc_paths[used], &file, i);
+        used   +=  size;
+    }
+
+    srvr_set_resources(rsrc_tokens, rsrc_handlers, len);
+}
+
+static void rsrc_add(uint8_t len, uint8_t* token, ResourceHandler* handler,
+                     uint8_t file) {
+
+    /* Shift greater tokens up by one to make room for @p token. */
+    while(len && strcmp(rsrc_tokens[len - 1], token) > 0) {
+        rsrc_tokens[len]    =  rsrc_tokens[len - 1];
+        rsrc_handlers[len]  =  rsrc_handlers[len - 1];
+        rsrc_files[len]     =  rsrc_files[len - 1];
+        --len;
+    }
+    rsrc_tokens[len]    =  token;
+    rsrc_handlers[len]  = *handler;
+    rsrc_files[len]     =  file;
 }
 
 void rsrc_set_parser(int8_t
@@ -76,8 +170,13 @@ void rsrc_set_parser(int8_t
 void rsrc_set_serial(void (*new_serialiser)(uint8_t**,
                                            ParamValue*,
                                            uint8_t len,
-                                           uint8_t ctr)) {
+                                           uint8_t ctr),
+                     uint16_t (*new_serial_len)(uint8_t**,
+                                                ParamValue*,
+                                                uint8_t len,
+                                                uint8_t ctr)) {
     serialiser  = new_serialiser;
+    serial_len  = new_serial_len;
 }
 
 void rsrc_set_handler(uint8_t uri,
@@ -92,13 +191,26 @@ void rsrc_set_handler(uint8_t uri,
 
 void rsrc_inform(struct HTTPRequest* req) {
     rsrc_get_qparam(req);
+    rsrc_get_etag(req);
+}
+
+static inline void rsrc_get_etag(struct HTTPRequest* req) {
+    FlsEntry entry;
+
+    if(rsrc_handlers[req->uri].call == &rsrc_handle_file) {
+        fls_toc_entry(rsrc_files[req->uri], &entry);
+        req->etag   =  entry.etag;
+    } else {
+        req->etag   =  0;
+    }
 }
 
 static inline void rsrc_get_qparam(struct HTTPRequest* req) {
     uint16_t offset;    /* QueryString.buf_i. */
     uint8_t i;          /* Number of permissible parameters. */
 
-    if(req->uri == RSRC_MEASUREMENT && req->method == METHOD_GET) {
+    if(rsrc_handlers[req->uri].call == &rsrc_handle_measurement
+    && req->method == METHOD_GET) {
         i = 4;
         offset = pgm_read_str_array(req->query.tokens,
                                     req->query.buf,
@@ -127,26 +239,16 @@ static inline void rsrc_get_qparam(struct HTTPRequest* req) {
     }
 }
 
-static ResourceHandler rsrc_handlers[RSRC_LEN] = {
+static ResourceHandler rsrc_fw_handlers[RSRC_FW_LEN] = {
     /* server * */
     {.methods = HTTP_OPTIONS,   .call = &rsrc_handle_server},
-    /* root / */
-    {.methods = HTTP_GET,       .call = &rsrc_handle_file},
-    /* client.js */
-    {.methods = HTTP_GET,       .call = &rsrc_handle_file},
     /* configuration */
     {.methods = HTTP_GET
               | HTTP_PUT,       .call = &rsrc_handle_configuration},
     /* coordinates */
     {.methods = HTTP_GET
               | HTTP_PUT,       .call = &rsrc_handle_coordinates},
-    /* index */
-    {.methods = HTTP_GET,       .call = &rsrc_handle_file},
-    /* logo.png */
-    {.methods = HTTP_GET,       .call = &rsrc_handle_file},
     /* /measurement */
     {.methods = HTTP_GET
-              | HTTP_POST,      .call = &rsrc_handle_measurement},
-    /* style.css */
-    {.methods = HTTP_GET,       .call = &rsrc_handle_file}
+              | HTTP_POST,      .call = &rsrc_handle_measurement}
 };
@@ -14,48 +14,6 @@ struct HTTPRequest;
 
 #include <inttypes.h>
 
-/**
-* @brief Index of / in #rsrc_handlers.
-*
-* Relative path of a virtual file.
-*/
-#define RSRC_ROOT           1
-
-/**
-* @brief Index of /client.js in #rsrc_handlers.
-*
-* Relative path of a virtual file.
-*/
-#define RSRC_CLIENT_JS      2
-
-/**
-* @brief Index of /index in #rsrc_handlers.
-*
-* Relative path of a virtual file.
-*/
-#define RSRC_INDEX          5
-
-/**
-* @brief Index of /logo.png in #rsrc_handlers.
-*
-* Relative path of a virtual file.
-*/
-#define RSRC_LOGO_PNG       6
-
-/**
-* @brief Index of /measurement in #rsrc_handlers.
-*
-* Provides access to query string parameters.
-*/
-#define RSRC_MEASUREMENT    7
-
-/**
-* @brief Index of /style.css in #rsrc_handlers.
-*
-* Relative path of a virtual file.
-*/
-#define RSRC_STYLE_CSS      8
-
 /**
 * @brief Specification of methods that trigger a particular callback function.
 *
@@ -149,6 +107,10 @@ typedef struct QueryString {
 *
 * This basically registers the resource tokens and handler function to the HTTP
 * server so that they may be invoked every time a resource token is matched.
+* Along with the resources of the firmware, the assets listed in the asset
+* directory of the Flash are registered (see #FLS_TOC_PAGE); so, the Flash
+* should be accessible by then. Those beyond #RSRC_FILES_MAX or #RSRC_PATHS_LEN
+* are not, which is reported if @c ENABLE_DEBUG is defined (see #DBG()).
 *
 * It suffices to call this only once; even if a particular handler is replaced
 * by another, there is no need for an update.
@@ -180,8 +142,17 @@ void rsrc_set_parser(int8_t (*parser)(uint8_t**, ParamValue*, uint8_t len));
 *
 * @param[in] serialiser Function pointer to the appropriate serialising function
 *   to use.
+* @param[in] serial_len Function pointer to the function that returns the size
+*   of the output of @p serialiser for the same arguments.
 */
-void rsrc_set_serial(void (*serialiser)(uint8_t**, ParamValue*, uint8_t len, uint8_t ctr));
+void rsrc_set_serial(void (*serialiser)(uint8_t**,
+                                       ParamValue*,
+                                       uint8_t len,
+                                       uint8_t ctr),
+                     uint16_t (*serial_len)(uint8_t**,
+                                            ParamValue*,
+                                            uint8_t len,
+                                            uint8_t ctr));
 
 /**
 * @brief Register a @p handler for specific @p methods on a particular @p uri.
@@ -214,7 +185,8 @@ void rsrc_set_handler(uint8_t uri,
 * not. One such example is the query string parameters. Only the appropriate
 * tokens are loaded into main memory for a particular URI-method pair.
 *
-* Currently, this function is a wrapper around rsrc_get_qparam().
+* Currently, this function is a wrapper around rsrc_get_qparam() and
+* rsrc_get_etag().
 *
 * @param[in,out] req An #HTTPRequest variable that has its .uri and .method
 *   members set. The appropriate members of @p req will be initialised.
@@ -248,4 +220,27 @@ void rsrc_inform(struct HTTPRequest* req);
 */
 static inline void rsrc_get_qparam(struct HTTPRequest* req);
 
+/**
+* @brief Sets @link HTTPRequest#etag etag@endlink of @p req to the entity tag
+* of the targeted asset, so that `If-None-Match' may be evaluated as it is read.
+*
+* Resources not served by rsrc_handle_file() have no entity tag; @c 0 is set.
+*
+* @param[in,out] req Accepts an #HTTPRequest variable that has its
+*   @link HTTPRequest#uri uri@endlink member set.
+*/
+static inline void rsrc_get_etag(struct HTTPRequest* req);
+
+/**
+* @brief Inserts resource @p token into #rsrc_tokens, keeping it sorted.
+*
+* @param[in] len The number of resources registered so far.
+* @param[in] token The absolute path of the resource.
+* @param[in] handler Its methods and handler.
+* @param[in] file Its entry of the asset directory, if it is served by
+*   rsrc_handle_file().
+*/
+static void rsrc_add(uint8_t len, uint8_t* token,
+                     struct ResourceHandler* handler, uint8_t file);
+
 #endif /* RESOURCE_H_INCL */
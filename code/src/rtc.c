@@ -53,7 +53,7 @@ int8_t rtc_read(uint8_t addr, uint8_t* buf, uint8_t len) {
     TWI_ATTEMPT(TWI_SLA_R(RTC_ADDR), TWI_SLA_R_ACK);
 
     /* Read @p len bytes acknowledging each except for the last one. */
-    do {
+    while(i < len - 1) {
         TWI_DO_ACK();
         TWI_ATTEMPT(TWI_WAIT(), TWI_DATA_R_ACK);
 
@@ -61,7 +61,7 @@ int8_t rtc_read(uint8_t addr, uint8_t* buf, uint8_t len) {
         buf[i]  =  byte;
 
         ++i;
-    } while(i < len - 1);
+    }
 
     /* Read the last byte of @p rtc without acknowledging it. *Atmel p.224*,
     * *DS1307 p.10* */
@@ -2,6 +2,7 @@
 #include "sbuffer.h"
 #include "w5100.h"
 #include <stdio.h>
+#include <string.h>
 
 /**
 * @ingroup sbuffer
@@ -35,10 +36,37 @@ static uint16_t buf_WR = 0;
 */
 static uint8_t  buf_Sn = 0;
 
+/**
+* @ingroup sbuffer
+* @brief The amount of data loaded into #buf since set_socket_buf().
+*/
+static uint16_t buf_in = 0;
+
+/**
+* @ingroup sbuffer
+* @brief The amount of data removed from the network module since
+* set_socket_buf().
+*
+* Data are only copied into #buf; they are removed once read (see s_free()).
+*/
+static uint16_t buf_out = 0;
+
 void set_socket_buf(uint8_t s) {
-    buf_RD = 0;
-    buf_WR = 0;
-    buf_Sn = s;
+    buf_RD   = 0;
+    buf_WR   = 0;
+    buf_data = 0;
+    buf_in   = 0;
+    buf_out  = 0;
+    buf_Sn   = s;
+}
+
+void s_release() {
+    s_free();
+    set_socket_buf(buf_Sn);
+}
+
+uint8_t get_socket_buf() {
+    return buf_Sn;
 }
 
 int8_t s_next(uint8_t* c) {
@@ -63,6 +91,49 @@ int8_t s_next(uint8_t* c) {
     return 0;
 }
 
+int8_t s_skip_to(uint8_t delim, uint8_t* c) {
+    uint8_t* found;
+    uint16_t len;   /* Bytes buffered contiguously from @c buf_RD. */
+
+    for(;;) {
+        /* Start over from the beginning of @c buf, so that the update is read
+        * in one piece rather than wrapped around its end. */
+        if(buf_data == 0) {
+            buf_RD  =  0;
+            buf_WR  =  0;
+            if(s_update()) return EOF;
+        }
+
+        len     =  buf_RD < buf_WR ? buf_WR - buf_RD : NET_BUF_LEN - buf_RD;
+        found   =  memchr(&buf[buf_RD], delim, len);
+        if(found) len = found - &buf[buf_RD] + 1;
+
+        buf_RD     +=  len;
+        buf_data   -=  len;
+        if(buf_RD == NET_BUF_LEN) buf_RD = 0;
+
+        if(found) {
+            *c  =  delim;
+            return 0;
+        }
+    }
+}
+
+uint16_t s_tell() {
+    return buf_in - buf_data;
+}
+
+int8_t s_tail(uint8_t* tail, uint8_t len) {
+    uint16_t rx_size    =  net_rx_size(buf_Sn);
+
+    /* Whatever has not been read is still in the network module, past the
+    * data read but not yet removed. */
+    if(rx_size - (s_tell() - buf_out) < len) return EOF;
+
+    net_peek(buf_Sn, rx_size - len, tail, len);
+    return 0;
+}
+
 int8_t s_peek(uint8_t* c, uint16_t pos) {
     /* If the offset from @c buf_RD (@p pos) exceeds the amount of available
     * bytes then more must be loaded into the local memory first. */
@@ -106,9 +177,10 @@ int8_t s_drop(uint16_t count) {
         * and @c buf_WR or the end of the buffer. */
         if(buf_RD < buf_WR || buf_RD + count <= NET_BUF_LEN) {
             buf_RD += count;
+            if(buf_RD == NET_BUF_LEN) buf_RD = 0;
 
         } else {
-            buf_RD = buf[count - (NET_BUF_LEN - buf_RD)];
+            buf_RD = count - (NET_BUF_LEN - buf_RD);
         }
 
         buf_data -= count;
@@ -122,42 +194,54 @@ int8_t s_drop(uint16_t count) {
     return 0;
 }
 
-static int8_t s_update() {
-    uint16_t rx_size = net_read16(NET_Sn_RX_RSR(buf_Sn)); /* Available data. */
-    uint16_t fragment; /* Actual amount of bytes to be read. */
-
-    /* Read a chunk from the available data up to a maximum of @c NET_BUF_SIZE
-    * and fit it into @c buf. */
-    if(rx_size > 0) {
-
-        /* @c buf may not be completely empty at the time of invocation. That
-        * amount of data is represented by @c buf_data and conserve space until
-        * read (ie, @buf_RD is promoted over them). */
-        if(rx_size <= NET_BUF_LEN - buf_data) {
-            fragment =  rx_size;
-        } else {
-            fragment = NET_BUF_LEN - buf_data;
-        }
+static void s_free() {
+    uint16_t len    =  s_tell() - buf_out;  /* Data read but not removed. */
 
-        /* Depending on the state of the RD/WR offsets, data may not be able to
-        * be written in one contiguous block but, rather, wrapped around the end
-        * of the buffer. */
-        if(buf_WR + fragment > NET_BUF_LEN) {
-            uint16_t bound = NET_BUF_LEN - buf_WR;
+    if(len) {
+        net_recv(buf_Sn, NULL, len);
+        buf_out    +=  len;
+    }
+}
 
-            net_recv(buf_Sn, &(buf[buf_WR]), bound); /* Read up to buffer limit. */
+static int8_t s_update() {
+    uint16_t pos;       /* Offset of the next byte to load within the socket. */
+    uint16_t avail;     /* Available data past @c pos, as last known. */
+    uint16_t fragment;  /* Actual amount of bytes to be read. */
+    uint16_t bound;     /* Bytes of @c fragment that fit before the end of
+                        * @c buf. */
+    uint16_t len;       /* Bytes read. */
+
+    /* Make room in the network module for more data. Whatever remains in it
+    * up to @c pos is already in @c buf. */
+    s_free();
+    pos         =  buf_in - buf_out;
+
+    /* Read a fragment of the available data up to the space left in @c buf.
+    * Should none be known to be available, ask for as much as fits; net_peek()
+    * checks anew. */
+    fragment    =  NET_BUF_LEN - buf_data;
+    if(!fragment) return 0;
+
+    avail       =  net_rx_size(buf_Sn) - pos;
+    if(avail && avail < fragment) fragment = avail;
+
+    /* Depending on the state of the RD/WR offsets, data may not be able to
+    * be written in one contiguous block but, rather, wrapped around the end
+    * of the buffer. */
+    bound       =  NET_BUF_LEN - buf_WR;
+    if(bound > fragment) bound = fragment;
+
+    len         =  net_peek(buf_Sn, pos, &buf[buf_WR], bound);
+    if(len == bound && fragment > bound) {
+        len    +=  net_peek(buf_Sn, pos + bound, buf, fragment - bound);
+    }
+    if(!len) return EOF;
 
-            /* Read the remainder of bytes. */
-            net_recv(buf_Sn, buf, fragment - bound);
-            buf_WR  = fragment - bound;     /* Update WR offset. */
-        } else {
-            net_recv(buf_Sn, &(buf[buf_WR]), fragment);
-            buf_WR += fragment; /* Update WR offset. */
-        }
+    /* Update WR offset. */
+    buf_WR     +=  len;
+    if(buf_WR >= NET_BUF_LEN) buf_WR -= NET_BUF_LEN;
 
-        buf_data += fragment;   /* Update the amount of in-buffer data. */
-    } else {
-        return EOF;
-    }
+    buf_data   +=  len;     /* Update the amount of in-buffer data. */
+    buf_in     +=  len;
     return 0;
 }
@@ -27,10 +27,33 @@
 * functions (or derivatives, thereof). It is not necessary to call this before
 * any other function, but only when switching input from a different socket.
 *
+* Data are copied into the internal buffer but only removed from the network
+* module once they have been read (see s_free()). Any data still buffered from
+* the previous socket are forgotten; those read since its last buffer update
+* remain in the network module, unless s_release() is called first.
+*
 * @param[in] s Socket to buffer data from.
 */
 void set_socket_buf(uint8_t s);
 
+/**
+* @brief Removes the data read so far from the network module and empties the
+* internal buffer.
+*
+* The data buffered but not read yet remain in the network module, to be read
+* anew, as if they never were; such as the part of a pipelined request that has
+* arrived so far.
+*/
+void s_release();
+
+/**
+* @brief Returns the socket specified by set_socket_buf().
+*
+* This is the socket of the request being serviced, hence, the one its response
+* is to be sent on.
+*/
+uint8_t get_socket_buf();
+
 /**
 * @brief Read the next byte from the network input stream.
 *
@@ -46,6 +69,45 @@ void set_socket_buf(uint8_t s);
 */
 int8_t s_next(uint8_t* c);
 
+/**
+* @brief Discard bytes from the network input stream up to and including the
+* next @p delim.
+*
+* It has the same outcome as calling s_next() until @p delim is read, but the
+* internal buffer is searched in place, a whole fragment at a time, and, once
+* depleted, refilled from its start in a single burst from the network module.
+* It is meant for data that are of no interest, such as the value of an unknown
+* header.
+*
+* @param[in] delim The byte to stop at.
+* @param[out] c The last byte read from the stream; @p delim, on success.
+* @returns @c 0 on success; #EOF on end-of-stream, having discarded everything.
+*/
+int8_t s_skip_to(uint8_t delim, uint8_t* c);
+
+/**
+* @brief Returns the amount of bytes consumed from the stream since
+* set_socket_buf().
+*
+* This is how far the stream has been read by s_next() and s_drop(); the
+* difference of two calls is the size of whatever was parsed in between.
+*/
+uint16_t s_tell();
+
+/**
+* @brief Copies into @p tail the last @p len bytes received so far, without
+* consuming any.
+*
+* These are the last of the stream as it currently stands, whether they have
+* been buffered already or are still in the network module; no buffer update is
+* caused.
+*
+* @param[out] tail The bytes copied. This should be at least @p len bytes long.
+* @param[in] len The amount of bytes to copy.
+* @returns 0 on success; #EOF, if fewer than @p len bytes remain in the stream.
+*/
+int8_t s_tail(uint8_t* tail, uint8_t len);
+
 /**
 * @brief Read into @p c the byte at offset @p pos from the current position in
 * the stream.
@@ -78,9 +140,11 @@ int8_t s_drop(uint16_t count);
 * @brief Update the contents of the internal network input buffer.
 *
 * When this function is invoked, a fragment of the available data on the socket
-* specified by set_socket_buf() are read into the internal buffer. The size of
-* the fragment is the least amount of bytes between the bytes available on the
-* socket and the available space (ie, consumed bytes) of the internal buffer.
+* specified by set_socket_buf() are copied into the internal buffer, past those
+* already copied. The size of the fragment is the least amount of bytes between
+* the bytes available on the socket and the available space (ie, consumed bytes)
+* of the internal buffer. The data read beforehand are removed from the socket
+* first (see s_free()).
 *
 * If s_update() is invoked when no data are available on the socket, #EOF is
 * returned and the internal buffer remains intact. If s_update() is invoked when
@@ -94,5 +158,13 @@ int8_t s_drop(uint16_t count);
 */
 static int8_t s_update();
 
+/**
+* @brief Removes the data read since the last call from the network module.
+*
+* This makes room for more data to arrive on the socket. Data that have been
+* copied into the internal buffer but not read yet are left in place.
+*/
+static void s_free();
+
 #endif /* SBUFFER_H_INCL */
 /** @} */
@@ -4,6 +4,7 @@
 #include "util.h"
 #include "motor.h"
 #include "sensor.h"
+#include "event.h"
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
@@ -58,6 +59,19 @@ static uint16_t task_estimate;
 */
 static Task task;
 
+/**
+* @brief Motor events reported by task_post_motor() and not yet handled by
+* task_update(); a bit per MTR_EVT_* value.
+*/
+static volatile uint8_t task_events;
+
+/**
+* @brief Positions reported along with #MTR_EVT_BUSY and #MTR_EVT_OK, in
+* #task_events.
+*/
+static Position task_busy_pos;
+static Position task_ok_pos;
+
 void task_init() {
     /* Default date limits. */
     BCDDate since   = {.year = 0x00, .mon = 0x01, .date = 0x01,
@@ -66,7 +80,7 @@ void task_init() {
                        .hour = 0x23, .min = 0x59, .sec  = 0x59};
     LogRecordSet    set;
     LogRecord       rec;
-    uint8_t         count;
+    uint16_t        count;
 
     /* Identify the time-stamp of the most recent sampling. */
     count   =  log_get_set(&set, &since, &until);
@@ -84,7 +98,7 @@ void task_init() {
         task_recent =  0;
     }
 
-    motor_set_callback(&task_handle_motor);
+    motor_set_callback(&task_post_motor);
 }
 
 int8_t task_set(Task* t) {
@@ -220,6 +234,38 @@ static uint16_t task_estimate_time(Position* new) {
     return time;
 }
 
+static void task_post_motor(Position pos, uint8_t evt) {
+    uint8_t sreg    =  SREG;
+
+    cli();
+    if(evt == MTR_EVT_BUSY) {
+        task_busy_pos   =  pos;
+    } else {
+        task_ok_pos     =  pos;
+    }
+    task_events    |=  _BV(evt);
+    SREG            =  sreg;
+
+    evt_post(EVT_MOTOR);
+}
+
+void task_update() {
+    Position busy;
+    Position ok;
+    uint8_t  events;
+
+    cli();
+    events      =  task_events;
+    task_events =  0;
+    busy        =  task_busy_pos;
+    ok          =  task_ok_pos;
+    sei();
+
+    /* A motion is always reported to begin before it completes. */
+    if(bit_is_set(events, MTR_EVT_BUSY)) task_handle_motor(busy, MTR_EVT_BUSY);
+    if(bit_is_set(events, MTR_EVT_OK))   task_handle_motor(ok,   MTR_EVT_OK);
+}
+
 static void task_handle_motor(Position pos, uint8_t evt) {
 
     switch(evt) {
@@ -298,16 +344,14 @@ static void task_handle_motor(Position pos, uint8_t evt) {
 * @brief Periodic automated sampling ISR.
 *
 * This is the Watchdog Timer ISR, responsible for waking the CPU every 8s (the
-* maximum interval for this MCU) to check whether there are tasks that should be
-* initiated automatically. They are only initiated granted the following:
-*   - No other task is currently in progress.
-*   - Task interval and samples have been specified (each, other than @c 0). See
-*       task_set().
-*   - The RTC is running.
-*   - The elapsed quanta since the most recently performed task are equal or
-*       greater the the specified interval (as set with task_set()).
+* maximum interval for this MCU). The checks themselves are deferred to
+* task_tick().
 */
 ISR(WDT_vect) {
+    evt_post(EVT_WDT);
+}
+
+void task_tick() {
     BCDDate now;
     uint8_t day;
     uint16_t now_stamp;
@@ -104,6 +104,28 @@ uint8_t task_pending();
 */
 uint16_t task_get_estimate();
 
+/**
+* @brief Checks whether there are tasks that should be initiated automatically.
+*
+* To be called at #WDT_TIMEOUT intervals (see #EVT_WDT). They are only
+* initiated granted the following:
+*   - No other task is currently in progress.
+*   - Task interval and samples have been specified (each, other than @c 0). See
+*       task_set().
+*   - The RTC is running.
+*   - The elapsed quanta since the most recently performed task are equal or
+*       greater the the specified interval (as set with task_set()).
+*/
+void task_tick();
+
+/**
+* @brief Handles the motor events reported since the previous call.
+*
+* To be called from the main loop, once #EVT_MOTOR has been posted (see
+* task_post_motor()).
+*/
+void task_update();
+
 /**
 * @brief Create an acceptable random coordinate.
 *
@@ -126,6 +148,18 @@ static void make_target(uint8_t* x, uint8_t* y);
 */
 static uint16_t task_estimate_time(Position* new);
 
+/**
+* @brief Motor callback.
+*
+* Motor events are mostly reported from the motor ISRs. This only records them
+* for task_update() to pass on to task_handle_motor() from the main loop.
+*
+* @param[in] pos The position of the device head, as given by #motor_callback.
+* @param[in] evt Status code describing the nature of the event, as given by
+*   #motor_callback.
+*/
+static void task_post_motor(Position pos, uint8_t evt);
+
 /**
 * @brief Motor event handler.
 *
@@ -1,6 +1,7 @@
 #include "util.h"
 #include "rtc.h"
 #include "flash.h"
+#include "w5100.h"
 
 #include <avr/pgmspace.h>
 #include <stdarg.h>
@@ -228,21 +229,42 @@ static inline void date_to_rtc(RTCMap* rtc, BCDDate* dt) {
     rtc->sec    =  dt->sec;
 }
 
-void fls_to_wiz(uint8_t s, uint16_t page, uint16_t len) {
-    uint16_t size   =  256;
+int8_t fls_to_wiz(uint8_t s, uint16_t page, uint16_t offset, uint16_t len) {
     uint8_t  buf[256];
+    uint16_t size;
+    uint16_t free_size;
+
+    /* From here on, @c offset is the byte of @c page to resume from. */
+    page       +=  offset >> 8;
+    offset     &=  0xFF;
 
     while(len) {
+        /* Read up to the end of the current page. */
+        size        =  256 - offset;
         if(len < size) size =  len;
 
+        /* Send as much as the Tx buffer currently accepts. Once full, flush it
+        * and wait for the peer to make room for (the rest of) the page. */
+        free_size   =  net_tx_free(s);
+        if(!free_size) {
+            free_size   =  net_wait_tx(s, size);
+            if(free_size < size) return -1;
+        }
+        if(free_size < size) size = free_size;
+
         /* Read @c size bytes from the Flash. */
-        fls_exchange(FLS_READ, page, buf, size);
+        fls_read(page, offset, buf, size);
 
         /* Send them to the W5100 HTTP server output buffer. */
-        net_send(s, buf, size, 0);
+        if(net_send(s, buf, size, 0) < size) return -1;
 
         /* Prepare for the next iteration. */
-        ++page;
-        len    -=  size;
+        offset     +=  size;
+        if(offset == 256) {
+            offset  =  0;
+            ++page;
+        }
+        len        -=  size;
     }
+    return 0;
 }
@@ -185,13 +185,19 @@ static inline void date_to_rtc(RTCMap* rtc, BCDDate* dt);
 /**
 * @brief Transfer data from Flash to the network module.
 *
-* The network module should have enough available buffer space to accommodate
-* the outgoing data. This function does not flush the output buffer.
+* The data are streamed in chunks that fit the available space of the output
+* buffer (see net_tx_free()). Whenever it fills up, it is flushed and the
+* transfer waits for the peer to acknowledge enough data (see net_wait_tx());
+* then, it resumes from the same byte of the Flash. So, @p len may exceed the
+* size of the output buffer. Data remaining at the end are not flushed.
 *
 * @param[in] Socket of the network module to write to.
-* @param[in] page The page to start reading from.
+* @param[in] page The page the data belong to.
+* @param[in] offset The byte to start reading from, counting from the start of
+*   @p page; it may well be beyond it.
 * @param[in] len The number of bytes to send.
+* @returns @c 0, on success; @c -1, if the connection has been lost.
 */
-void fls_to_wiz(uint8_t s, uint16_t page, uint16_t len);
+int8_t fls_to_wiz(uint8_t s, uint16_t page, uint16_t offset, uint16_t len);
 
 #endif /* UTIL_H_INCL */
@@ -4,6 +4,8 @@
 
 #include <util/delay.h>
 #include <avr/io.h>
+#include <stddef.h>
+#include <string.h>
 
 /**
 * @brief The absolute Tx address for each socket.
@@ -43,6 +45,95 @@ static uint16_t rx_mask[4];
 */
 static uint16_t socket_contents[4];
 
+/**
+* @brief Sockets with a @c SEND command in flight; a bit per socket.
+*
+* Set by net_send() upon issuing #NET_Sn_CR_SEND and cleared once the W5100
+* reports its completion, either to net_send() itself or to net_read_ir().
+*/
+static uint8_t tx_in_flight;
+
+/**
+* @brief Sockets that have failed to accept data passed to net_send(); a bit
+* per socket.
+*
+* Once set, net_send() accepts nothing more for the socket, so that a response
+* is never sent with a part of it missing. Cleared by net_socket_open().
+*/
+static uint8_t tx_lost;
+
+/**
+* @brief Data passed to net_send() but not yet written to the W5100.
+*
+* Only one socket at a time is written to, so all share a single buffer, which
+* is spilled before any other socket is written to.
+*/
+static uint8_t stage[NET_STAGE_LEN];
+
+/**
+* @brief The amount of data in #stage.
+*/
+static uint16_t stage_len;
+
+/**
+* @brief The socket the data in #stage are meant for.
+*/
+static uint8_t stage_Sn;
+
+/**
+* @brief Shadow of #NET_Sn_TX_WR for each socket.
+*
+* Only ever written by the MCU, so it is read once per connection (see
+* net_shadow()) and kept up to date by net_send() thereafter.
+*/
+static uint16_t tx_wr[4];
+
+/**
+* @brief Shadow of #NET_Sn_TX_FSR for each socket.
+*
+* The free size, as last read, less the data sent since. The actual one only
+* grows as the peer acknowledges data, so this is never more than it; it is read
+* anew on #NET_Sn_IR_SEND_OK (see net_read_ir()) or when found too small.
+*/
+static uint16_t tx_fsr[4];
+
+/**
+* @brief Shadow of #NET_Sn_RX_RR for each socket.
+*
+* Only ever written by the MCU; see #tx_wr.
+*/
+static uint16_t rx_rr[4];
+
+/**
+* @brief Shadow of #NET_Sn_RX_RSR for each socket.
+*
+* The received size, as last read, less the data read since. The actual one
+* only grows as data arrive, so this is never more than it; it is read anew on
+* #NET_Sn_IR_RECV (see net_read_ir()), when found empty or when net_peek() finds
+* it insufficient.
+*/
+static uint16_t rx_rsr[4];
+
+/**
+* @brief Sockets whose shadow registers hold; a bit per socket.
+*
+* Cleared by net_invalidate().
+*/
+static uint8_t shadow_valid;
+
+/**
+* @brief Loads the shadow registers of socket @p s, unless they already hold.
+*/
+static void net_shadow(uint8_t s) {
+    if(bit_is_set(shadow_valid, s)) return;
+
+    tx_wr[s]        =  net_read16(NET_Sn_TX_WR(s));
+    tx_fsr[s]       =  net_read16(NET_Sn_TX_FSR(s));
+    rx_rr[s]        =  net_read16(NET_Sn_RX_RR(s));
+    rx_rsr[s]       =  net_read16(NET_Sn_RX_RSR(s));
+    shadow_valid   |=  _BV(s);
+}
+
 void net_socket_init(uint8_t tx, uint8_t rx) {
     uint16_t tx_sum =  0;       /* Sum of previously allocated Tx buffers. */
     uint16_t rx_sum =  0;       /* Sum of previously allocated Rx buffers. */
@@ -77,8 +168,17 @@ void net_socket_init(uint8_t tx, uint8_t rx) {
 
 void net_socket_open(uint8_t s, uint8_t mode, uint16_t port) {
 
-    /* Close Socket @p s. */
+    /* Close Socket @p s. Nothing of its previous connection remains to be
+    * sent. */
     net_write8(NET_Sn_CR(s), NET_Sn_CR_CLOSE);
+    socket_contents[s]  =  0;
+    tx_in_flight       &= ~_BV(s);
+    tx_lost            &= ~_BV(s);
+    if(stage_Sn == s) stage_len = 0;
+
+    /* The pointers of the next connection are only known once established. */
+    net_invalidate(s);
+
     net_write8(NET_Sn_MR(s), mode);
     net_write16(NET_Sn_PORT(s), port);
     net_write8(NET_Sn_CR(s), NET_Sn_CR_OPEN);
@@ -132,6 +232,10 @@ void inline net_read(uint16_t addr, uint8_t* buf, uint16_t len) {
 void net_exchange(uint8_t c, uint16_t addr, uint8_t* buf, uint16_t len) {
     uint8_t update  = c == 0x0F;
     uint8_t byte;
+#ifndef SPI_POLLED
+    uint8_t addr_hi;
+    uint8_t addr_lo;
+#endif
     uint16_t i;
 
     net_select();
@@ -142,6 +246,7 @@ void net_exchange(uint8_t c, uint16_t addr, uint8_t* buf, uint16_t len) {
         * of 21ns before sending any CLK pulses. *W5100 p.67* */
         NET_ENABLE();
 
+#ifdef SPI_POLLED
         SPDR    = c;
         loop_until_bit_is_set(SPSR, SPIF);
 
@@ -153,6 +258,24 @@ void net_exchange(uint8_t c, uint16_t addr, uint8_t* buf, uint16_t len) {
 
         SPDR    = buf[i];
         loop_until_bit_is_set(SPSR, SPIF);
+#else
+        /* Each byte of the frame is ready by the time the previous one has
+        * been shifted. */
+        SPDR    = c;
+        addr_hi = addr >> 8;
+        addr_lo = addr;
+        byte    = buf[i];
+        loop_until_bit_is_set(SPSR, SPIF);
+
+        SPDR    = addr_hi;
+        loop_until_bit_is_set(SPSR, SPIF);
+
+        SPDR    = addr_lo;
+        loop_until_bit_is_set(SPSR, SPIF);
+
+        SPDR    = byte;
+        loop_until_bit_is_set(SPSR, SPIF);
+#endif
 
         if(update) {
             buf[i] = SPDR;
@@ -168,16 +291,129 @@ void net_exchange(uint8_t c, uint16_t addr, uint8_t* buf, uint16_t len) {
     SPCR       &= ~_BV(SPE);
 }
 
-uint16_t net_send(uint8_t s, uint8_t* buf, uint16_t len, uint8_t flush) {
-    uint16_t free_size  =  net_read16(NET_Sn_TX_FSR(s));
+/**
+* @brief Waits for the @c SEND command in flight on socket @p s, if any, to
+* complete.
+*
+* Should the connection be lost, #NET_Sn_IR_SEND_OK never follows; the wait
+* ends on #NET_Sn_IR_TIMEOUT, instead, which is left for the socket handler.
+*/
+static void net_wait_send(uint8_t s) {
+    uint8_t status;
+
+    if(bit_is_clear(tx_in_flight, s)) return;
+
+    do {
+        status = net_read8(NET_Sn_IR(s));
+    } while(bit_is_clear(status, NET_Sn_IR_SEND_OK)
+         && bit_is_clear(status, NET_Sn_IR_TIMEOUT));
+
+    /* Clear the flag (by writing 1) so that the next SEND waits anew. */
+    net_write8(NET_Sn_IR(s), _BV(NET_Sn_IR_SEND_OK));
+    tx_in_flight   &= ~_BV(s);
+}
+
+uint8_t net_read_ir(uint8_t s) {
+    uint8_t status  =  net_read8(NET_Sn_IR(s));
+
+    /* Clear #NET_Sn_IR_SEND_OK right away, rather than along with the other
+    * flags, lest the completion of a subsequent SEND be cleared unnoticed. */
+    if(bit_is_set(status, NET_Sn_IR_SEND_OK)) {
+        net_write8(NET_Sn_IR(s), _BV(NET_Sn_IR_SEND_OK));
+        tx_in_flight   &= ~_BV(s);
+    }
+
+    /* Space has been freed or data have arrived since the shadows were last
+    * refreshed. */
+    if(bit_is_set(shadow_valid, s)) {
+        if(bit_is_set(status, NET_Sn_IR_SEND_OK)) {
+            tx_fsr[s]   =  net_read16(NET_Sn_TX_FSR(s));
+        }
+        if(bit_is_set(status, NET_Sn_IR_RECV)) {
+            rx_rsr[s]   =  net_read16(NET_Sn_RX_RSR(s));
+        }
+    }
+    return status;
+}
+
+void net_invalidate(uint8_t s) {
+    shadow_valid   &= ~_BV(s);
+}
+
+uint16_t net_rx_size(uint8_t s) {
+    net_shadow(s);
+    if(!rx_rsr[s]) rx_rsr[s] = net_read16(NET_Sn_RX_RSR(s));
+    return rx_rsr[s];
+}
+
+uint8_t net_is_sending(uint8_t s) {
+    return bit_is_set(tx_in_flight, s);
+}
+
+uint8_t net_is_lost(uint8_t s) {
+    return bit_is_set(tx_lost, s);
+}
+
+uint16_t net_tx_free(uint8_t s) {
+    net_shadow(s);
+    return tx_fsr[s] - socket_contents[s] - (stage_Sn == s ? stage_len : 0);
+}
+
+uint16_t net_wait_tx(uint8_t s, uint16_t len) {
+    uint16_t free_size;
+    uint8_t  sn_SR;
+    uint16_t polls  =  NET_TX_TIMEOUT;
+
+    if(socket_contents[s] || (stage_len && stage_Sn == s)) {
+        net_send(s, NULL, 0, 1);
+    }
+
+    do {
+        free_size   =  net_read16(NET_Sn_TX_FSR(s));
+        sn_SR       =  net_read8(NET_Sn_SR(s));
+        if(free_size >= len || !polls--) break;
+
+        /* A millisecond at #F_CPU_FAST; the delay is converted at #F_CPU. */
+        _delay_ms(F_CPU_FAST / F_CPU);
+    } while(sn_SR == NET_Sn_SR_ESTAB || sn_SR == NET_Sn_SR_CLOSEWAIT);
+
+    tx_fsr[s]   =  free_size;
+    return free_size;
+}
+
+/**
+* @brief Writes @p len bytes of @p buf to the Tx buffer of socket @p s,
+* sending them out, if @p flush is non-zero.
+*
+* This is net_send() without staging.
+*
+* @returns As net_send().
+*/
+static uint16_t net_write_tx(uint8_t s, uint8_t* buf, uint16_t len,
+                             uint8_t flush) {
+    uint16_t free_size;
     uint16_t s_content  =  socket_contents[s];
 
-    /* Is there enough available space? */
-    if(free_size < s_content + len) return free_size - s_content - len;
+    /* Is there enough available space? The shadow may understate it; if so,
+    * ask the W5100. If not, but @p len could ever fit, wait for the peer to
+    * make room. */
+    free_size   =  tx_fsr[s];
+    if(free_size < s_content + len) {
+        free_size   =  net_read16(NET_Sn_TX_FSR(s));
+        tx_fsr[s]   =  free_size;
+    }
+    if(free_size < s_content + len && len <= tx_mask[s] + 1) {
+        free_size   =  net_wait_tx(s, len);
+        s_content   =  socket_contents[s];
+    }
+    if(free_size < s_content + len) {
+        tx_lost    |=  _BV(s);
+        return 0;
+    }
 
     /* Send data from local buffer to W5100 buffer. */
 
-    uint16_t tx_WR      =  net_read16(NET_Sn_TX_WR(s));
+    uint16_t tx_WR      =  tx_wr[s];
 
     /* Offset from the (sub)buffer base. */
     uint16_t tx_offset  =  (tx_WR + s_content) & tx_mask[s];
@@ -207,31 +443,74 @@ uint16_t net_send(uint8_t s, uint8_t* buf, uint16_t len, uint8_t flush) {
 
     s_content  +=  len;
     if(flush) {
-        uint8_t status;
         tx_WR  +=  s_content;
 
+        /* Only a single SEND may be in flight. The data above have been
+        * appended in the meantime, though. */
+        net_wait_send(s);
+
         net_write16(NET_Sn_TX_WR(s), tx_WR);
         net_write8(NET_Sn_CR(s), NET_Sn_CR_SEND);
+        tx_wr[s]    =  tx_WR;
+        tx_fsr[s]  -=  s_content;
 
-        do {
-            status = net_read8(NET_Sn_IR(s));
-        } while((status & NET_Sn_IR_SEND_OK) != NET_Sn_IR_SEND_OK);
+        /* Do not wait for the data to be sent; the next chunk may be prepared
+        * meanwhile. */
+        tx_in_flight   |=  _BV(s);
 
         s_content = 0;
     }
     socket_contents[s]  =  s_content;
-    return sock_size    -  s_content;
+    return len;
 }
 
-uint16_t net_recv(uint8_t s, uint8_t* buf, uint16_t len) {
-    uint16_t rx_size    =  net_read16(NET_Sn_RX_RSR(s));
-    uint16_t rx_RR      =  net_read16(NET_Sn_RX_RR(s));
+/**
+* @brief Writes the data staged by net_send() out to the W5100, sending them
+* along with any previously written ones, if @p flush is non-zero.
+*
+* The staged data are only ever as many as the W5100 is known to have room for,
+* so they are always written.
+*/
+static void net_spill(uint8_t flush) {
+    uint16_t len    =  stage_len;
 
-    /* Read at most @p len bytes. */
-    if(len < rx_size) rx_size = len;
+    stage_len   =  0;
+    net_write_tx(stage_Sn, stage, len, flush);
+}
+
+uint16_t net_send(uint8_t s, uint8_t* buf, uint16_t len, uint8_t flush) {
+
+    if(bit_is_set(tx_lost, s)) return 0;
+
+    /* Whatever is staged for another socket is written out first. */
+    if(stage_len && stage_Sn != s) net_spill(0);
+
+    /* Stage @p buf, as long as it fits both here and in the W5100 (as far as it
+    * is known to fit without asking). */
+    net_shadow(s);
+    if(stage_len + len <= NET_STAGE_LEN
+    && stage_len + len <= tx_fsr[s] - socket_contents[s]) {
+        if(len) memcpy(&stage[stage_len], buf, len);
+        stage_Sn    =  s;
+        stage_len  +=  len;
+
+        if(flush) net_spill(1);
+        return len;
+    }
+
+    /* Otherwise, write the staged data out ahead of @p buf. */
+    if(stage_len) net_spill(0);
+    return net_write_tx(s, buf, len, flush);
+}
+
+/**
+* @brief Reads @p len bytes of the input buffer of socket @p s, starting @p rr
+* (a value of #NET_Sn_RX_RR); the buffer wraps around.
+*/
+static void net_read_rx(uint8_t s, uint16_t rr, uint8_t* buf, uint16_t len) {
 
     /* Offset from (sub)buffer base. */
-    uint16_t rx_offset  =  rx_RR & rx_mask[s];
+    uint16_t rx_offset  =  rr & rx_mask[s];
 
     /* Physical address to start reading from. */
     uint16_t start_addr =  rx_base[s] + rx_offset;
@@ -240,7 +519,7 @@ uint16_t net_recv(uint8_t s, uint8_t* buf, uint16_t len) {
     /* If incoming (data size + current read offset) exceeds buffer limit, then
      * overflow has occurred. Read data from the current offset up to limit, and
      * then, the remainder of bytes from (sub)buffer base. */
-    if(rx_offset + rx_size > sock_size) {
+    if(rx_offset + len > sock_size) {
         /* Bytes until upper-bound. */
         uint16_t bound  = sock_size - rx_offset;
 
@@ -248,14 +527,41 @@ uint16_t net_recv(uint8_t s, uint8_t* buf, uint16_t len) {
         net_read(start_addr, buf, bound);
 
         /* Read the rest of the bytes, starting off from the base. */
-        net_read(rx_base[s], buf + bound, rx_size - bound);
+        net_read(rx_base[s], buf + bound, len - bound);
     } else {
-        net_read(start_addr, buf, rx_size);
+        net_read(start_addr, buf, len);
     }
+}
+
+uint16_t net_recv(uint8_t s, uint8_t* buf, uint16_t len) {
+    uint16_t rx_size    =  net_rx_size(s);
+
+    /* Read at most @p len bytes. */
+    if(len < rx_size) rx_size = len;
+
+    if(buf) net_read_rx(s, rx_rr[s], buf, rx_size);
 
     /* Update RR pointer for future reads. */
-    net_write16(NET_Sn_RX_RR(s), rx_RR + rx_size);
+    rx_rr[s]       +=  rx_size;
+    rx_rsr[s]      -=  rx_size;
+    net_write16(NET_Sn_RX_RR(s), rx_rr[s]);
     net_write8(NET_Sn_CR(s), NET_Sn_CR_RECV);
 
     return rx_size - len;
 }
+
+uint16_t net_peek(uint8_t s, uint16_t pos, uint8_t* buf, uint16_t len) {
+    uint16_t rx_size    =  net_rx_size(s);
+
+    /* The received size only grows; read it anew, if found insufficient. */
+    if(pos + len > rx_size) {
+        rx_size         =  net_read16(NET_Sn_RX_RSR(s));
+        rx_rsr[s]       =  rx_size;
+    }
+
+    if(pos >= rx_size) return 0;
+    if(len > rx_size - pos) len = rx_size - pos;
+
+    net_read_rx(s, rx_rr[s] + pos, buf, len);
+    return len;
+}
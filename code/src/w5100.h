@@ -507,6 +507,11 @@ void net_exchange(uint8_t c, uint16_t addr, uint8_t* buf, uint16_t len);
 /**
 * @brief Send data to a W5100 Socket output buffer.
 *
+* Short writes are staged in SRAM (up to #NET_STAGE_LEN bytes) and only written
+* to the W5100 once that fills up, another socket is written to or the data
+* are flushed; the many fragments a response is composed of thus cost a single
+* SPI transfer, rather than one each.
+*
 * It is safe to call this function with a @p len of @c 0 and @p flush of
 * non-zero to sent any previously set W5100 buffer data on socket @p s. In this
 * case, @p buf could be @c NULL.
@@ -517,25 +522,137 @@ void net_exchange(uint8_t c, uint16_t addr, uint8_t* buf, uint16_t len);
 * @param[in] The number of bytes to copy from @p buf into the W5100 output
 *   buffer.
 * @param[in] flush Designates whether data in @buf along with all previously
-*   unsent data of socket @p s should be sent out with this call.
-* @returns @c The available space in the output buffer of W5100 for socket @c s
-*   (after appending @p len bytes from @p buf), if @p flush was @c 0; the socket
-*   size (in bytes), if the buffer was just flushed (ie, @p flush was non-zero);
-*   a negative number for the amount of bytes that cannot fit into the available
-*   space.
+*   unsent data of socket @p s should be sent out with this call. The @c SEND
+*   command is issued without waiting for it to complete (see net_is_sending());
+*   only a @c SEND still in flight from a previous call is waited for.
+* @returns The amount of bytes of @p buf accepted; either @p len or, should they
+*   not fit in the output buffer even once the peer has made room for them (the
+*   connection has been lost), @c 0. Accepted data are sent along with the rest,
+*   whether they are staged or already written to the W5100. Once less than
+*   @p len, nothing more is accepted until the socket is opened anew (see
+*   net_is_lost()); callers should compare this against @p len and abandon the
+*   response.
 */
 uint16_t net_send(uint8_t s, uint8_t* buf, uint16_t len, uint8_t flush);
 
+/**
+* @brief Returns the space of the Tx buffer of socket @p s that may still be
+* appended to.
+*
+* This is the free space the W5100 last reported (#NET_Sn_TX_FSR), less any
+* data sent, appended or staged by net_send() since. The register is not read
+* anew, so the actual space may well be larger (see net_wait_tx()).
+*
+* @param[in] s The socket (@c 0--@c 3).
+* @returns The available space in bytes.
+*/
+uint16_t net_tx_free(uint8_t s);
+
+/**
+* @brief Waits for the W5100 to free at least @p len bytes of the Tx buffer of
+* socket @p s.
+*
+* Any data appended (but not yet sent) are sent out first, since only sent data
+* may be acknowledged by the peer and, thus, release their space.
+*
+* The wait lasts no longer than #NET_TX_TIMEOUT, lest a peer that stops reading
+* holds up the main loop.
+*
+* @param[in] s The socket (@c 0--@c 3).
+* @param[in] len The space to wait for; at most the size of the buffer.
+* @returns The available space; less than @p len if the connection is lost or
+*   the peer has not made room in time.
+*/
+uint16_t net_wait_tx(uint8_t s, uint16_t len);
+
+/**
+* @brief Reads the interrupt register of socket @p s (#NET_Sn_IR).
+*
+* #NET_Sn_IR_SEND_OK, if set, is cleared at once and completes the @c SEND in
+* flight (see net_send()). The other flags are left for the caller to clear.
+*
+* Also refreshes the shadows of #NET_Sn_TX_FSR and #NET_Sn_RX_RSR, if
+* #NET_Sn_IR_SEND_OK and #NET_Sn_IR_RECV, respectively, are set.
+*
+* @param[in] s The socket (@c 0--@c 3).
+* @returns The value of #NET_Sn_IR.
+*/
+uint8_t net_read_ir(uint8_t s);
+
+/**
+* @brief Invalidates the shadow registers of socket @p s.
+*
+* The socket registers that only change at the request of the MCU
+* (#NET_Sn_TX_WR and #NET_Sn_RX_RR) are read once per connection and tracked
+* locally thereafter; so are the free (#NET_Sn_TX_FSR) and received
+* (#NET_Sn_RX_RSR) sizes, which are only read anew on interrupts or when found
+* insufficient. This should be called whenever the W5100 may have reset them
+* behind the back of net_send() and net_recv(), such as on opening the socket
+* (see net_socket_open()); the next access reloads them.
+*
+* @param[in] s The socket (@c 0--@c 3).
+*/
+void net_invalidate(uint8_t s);
+
+/**
+* @brief Returns the amount of data received on socket @p s and not yet read
+* (#NET_Sn_RX_RSR).
+*
+* This is the size last reported by the W5100, less any data read by
+* net_recv() since; it is only read anew once that is exhausted.
+*
+* @param[in] s The socket (@c 0--@c 3).
+* @returns The available data in bytes.
+*/
+uint16_t net_rx_size(uint8_t s);
+
+/**
+* @brief Returns whether a @c SEND command issued by net_send() on socket @p s
+* has yet to complete.
+*
+* @param[in] s The socket (@c 0--@c 3).
+* @returns @c 0, if it has not; non-zero, otherwise.
+*/
+uint8_t net_is_sending(uint8_t s);
+
+/**
+* @brief Returns whether socket @p s has failed to accept data passed to
+* net_send() since it was last opened.
+*
+* @param[in] s The socket (@c 0--@c 3).
+* @returns Non-zero, if it has; @c 0, otherwise.
+*/
+uint8_t net_is_lost(uint8_t s);
+
 /**
 * @brief Receive data from a W5100 Socket input buffer.
 *
 * @param[in] s The socket to read data from.
 * @param[in] buf Array of bytes read. This should be at least @p len bytes long.
+*   If @c NULL, the bytes are discarded without being copied.
 * @param[in] The number of bytes to read from the W5100 buffer.
 * @returns @c The available bytes in the input buffer (after reading @p len
 *   bytes).
 */
 uint16_t net_recv(uint8_t s, uint8_t* buf, uint16_t len);
 
+/**
+* @brief Copies data received on socket @p s without reading them.
+*
+* The data remain in the input buffer of the W5100, as if this was never called;
+* neither #NET_Sn_RX_RR nor the receive window of the socket change. The
+* received size is read anew, if fewer than @p len bytes past @p pos are known
+* to be available.
+*
+* @param[in] s The socket to copy data from.
+* @param[in] pos Offset of the first byte to copy from the next one to read.
+* @param[out] buf Array of bytes copied. This should be at least @p len bytes
+*   long.
+* @param[in] len The number of bytes to copy.
+* @returns The number of bytes copied; fewer than @p len, if fewer are available
+*   past @p pos.
+*/
+uint16_t net_peek(uint8_t s, uint16_t pos, uint8_t* buf, uint16_t len);
+
 #endif /* W5100_H_INCL */
 /** @} */